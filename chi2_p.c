@@ -0,0 +1,227 @@
+/*
+ *  double chi2_p(double x, double df, int upper)
+ *    returns lower or upper probability
+ *    of chi-square distribution.
+ *  double chi2_q(double t, double df, int upper)
+ *    returns the chi-square value with lower or upper probability t.
+ *  double stirlerr(double a)
+ *    returns the error of Stirling's formula
+ *    log(Gamma(a+1)) - (a+0.5)*log(a) + a - log(sqrt(2*pi)).
+ *
+ *  Arguments
+ *    x:     chi-square value
+ *    df:    degrees of freedom (df > 0, need not be an integer)
+ *    upper: upper==0 -> lower probability
+ *           upper==1 -> upper probability
+ *    t:     probability of chi2_q() (0 < t < 1)
+ *    a:     argument of stirlerr() (a > 0)
+ *
+ *  Required functions
+ *    extern double nrml_q()
+ *    static double bd0()
+ *    static double dgam()
+ *    static double lgam1()
+ *
+ *  Include files
+ *    <math.h>
+ *
+ *  References
+ *    Press, W. H., S. A. Teukolsky, W. T. Vetterling and
+ *      B. P. Flannery (1992).
+ *      Numerical Recipes in C, 2nd ed., Section 6.2,
+ *      Cambridge University Press.
+ *    Loader, C. (2000).
+ *      Fast and accurate computation of binomial probabilities,
+ *      (unpublished manuscript; used in dbinom() of R).
+ *
+ *  Note
+ *    1) The regularised incomplete gamma function P(a, x) with
+ *       a=df/2 and x/2 is computed by the power series if
+ *       x/2 < a+1, and Q(a, x)=1-P(a, x) by the continued fraction
+ *       (modified Lentz's method) otherwise.  The smaller one of P
+ *       and Q is computed directly, so the tail is accurate in the
+ *       relative sense.
+ *    2) The factor x^a exp(-x)/Gamma(a+1) is computed as
+ *       exp(-stirlerr(a) - bd0(a, x))/sqrt(2*pi*a) (Loader), which
+ *       does not lose accuracy for large a.
+ *    3) The absolute error is of order e-16, and the relative error
+ *       of the directly computed tail is of order e-13 for
+ *       df <= 10000.
+ *    4) chi2_q() takes Newton steps in log(x) on log(P) or log(Q)
+ *       from the Wilson-Hilferty approximation, or from
+ *       (x/2)^a/Gamma(a+1) for the far lower tail, until the relative
+ *       step is below 1e-12.  The steps are limited to a factor of e,
+ *       and bisection in log(x) is taken if a step leaves the bracket
+ *       of the values so far (P or Q may underflow there).  The tail
+ *       probability t may be as small as 1e-300.
+ *    5) lgamma() is not used, since it writes the global signgam
+ *       and is not reentrant (smrng_tbl runs several threads).
+ *       log(Gamma(a+1)) is log(tgamma(a+1)) for a <= 15 and the
+ *       Stirling series of stirlerr() above (lgam1()).
+ *
+ *  Stored in
+ *   chi2_p.c
+ *
+ *  History
+ *    2026-10-16: Created for the closed-form chi tail of smrng_lp().
+ *                chi2_q() for quantiles.
+ *                Reentrant without lgamma().
+ *
+ *  License
+ *    GPLv3 (Free and No Warranty)
+ *    https://www.gnu.org/licenses/
+ *
+ *  Coded by Tetsuhisa Miwa.
+ */
+
+
+#include <math.h>
+#define LOGSQRT2PI 0.918938533204672741780329736405617640  // log(sqrt(2*pi))
+#define PI2        6.28318530717958647692528676655900577   // 2*pi
+#define EPS        1.0e-16  // relative precision of series and fraction
+#define ITMAX      10000    // maximum number of terms
+#define FPMIN      1.0e-300 // small number for Lentz's method
+
+extern double nrml_q(double p, int upper);
+
+double stirlerr(double a)
+{
+  double  a2;
+
+  if(a <= 15.0)
+    return(log(tgamma(a + 1.0)) - (a + 0.5)*log(a) + a - LOGSQRT2PI);
+  a2 = a*a;
+  return((1.0/12.0 - (1.0/360.0 - (1.0/1260.0 - 1.0/(1680.0*a2))/a2)/a2)/a);
+}
+
+/* log(Gamma(a+1)) for a > 0 (Note 5).
+ */
+static double lgam1(double a)
+{
+  if(a <= 15.0)
+    return(log(tgamma(a + 1.0)));
+  return(stirlerr(a) + (a + 0.5)*log(a) - a + LOGSQRT2PI);
+}
+
+/* Deviance term a*log(a/x) + x - a without cancellation.
+ */
+static double bd0(double a, double x)
+{
+  double  v, s, s1, ej;
+  int     j;
+
+  if(fabs(a - x) < 0.1*(a + x)) {
+    v = (a - x)/(a + x);
+    s = (a - x)*v;
+    ej = 2.0*a*v;
+    v *= v;
+    for(j=1; j < ITMAX; j++) {
+      ej *= v;
+      s1 = s + ej/(2*j + 1);
+      if(s1 == s)
+        return(s1);
+      s = s1;
+    }
+    return(s);
+  }
+  return(a*log(a/x) + x - a);
+}
+
+/* x^a exp(-x)/Gamma(a+1)
+ */
+static double dgam(double a, double x)
+{
+  return(exp(-stirlerr(a) - bd0(a, x))/sqrt(PI2*a));
+}
+
+double chi2_p(double x, double df, int upper)
+{
+  double  a=0.5*df, p, sum, del, an, b, c, d, h;
+  int     n;
+
+  if(x <= 0.0)
+    return(upper ? 1.0 : 0.0);
+  x *= 0.5;
+
+  if(x < a + 1.0) {
+    // Series: P(a, x) = dgam(a, x) \sum_n x^n/((a+1)...(a+n))
+    sum = del = 1.0;
+    for(n=1; n < ITMAX; n++) {
+      del *= x/(a + n);
+      sum += del;
+      if(fabs(del) < fabs(sum)*EPS)
+        break;
+    }
+    p = dgam(a, x)*sum;
+    return(upper ? 1.0 - p : p);
+  }
+
+  // Continued fraction: Q(a, x) = a*dgam(a, x) h
+  b = x + 1.0 - a;
+  c = 1.0/FPMIN;
+  d = 1.0/b;
+  h = d;
+  for(n=1; n < ITMAX; n++) {
+    an = -n*(n - a);
+    b += 2.0;
+    d = an*d + b;
+    if(fabs(d) < FPMIN)
+      d = FPMIN;
+    c = b + an/c;
+    if(fabs(c) < FPMIN)
+      c = FPMIN;
+    d = 1.0/d;
+    del = d*c;
+    h *= del;
+    if(fabs(del - 1.0) < EPS)
+      break;
+  }
+  p = a*dgam(a, x)*h;
+  return(upper ? p : 1.0 - p);
+}
+
+double chi2_q(double t, double df, int upper)
+{
+  double  a=0.5*df, x, y, d, dx, w, xl, xh, xn;
+  int     i;
+
+  if(t <= 0.0)
+    return(upper ? HUGE_VAL : 0.0);
+  if(t >= 1.0)
+    return(upper ? 0.0 : HUGE_VAL);
+
+  // Wilson-Hilferty, or (x/2)^a/Gamma(a+1) for the far lower tail.
+  w = 1.0 - 2.0/(9.0*df) + nrml_q(t, upper)*sqrt(2.0/(9.0*df));
+  if(w > 0.2)
+    x = df*w*w*w;
+  else
+    x = 2.0*exp(((upper ? log1p(-t) : log(t)) + lgam1(a))/a);
+
+  // The quantile lies in (xl, xh).
+  xl = 0.0;
+  xh = HUGE_VAL;
+  for(i=0; i < 100; i++) {
+    y = chi2_p(x, df, upper);
+    if(upper ? (y > t) : (y < t))
+      xl = x;
+    else
+      xh = x;
+    if(y > 0.0) {
+      // d log(P or Q)/d log(x)
+      d = exp(a*log(0.5*x) - 0.5*x - lgam1(a) + log(a))/y;
+      dx = (log(y) - log(t))/d;
+      if(upper)
+        dx = -dx;
+    }
+    else
+      dx = upper ? 1.0 : -1.0;
+    xn = x*exp(-fmax(-1.0, fmin(1.0, dx)));
+    if((xn <= xl || xn >= xh) && dx != 0.0 && xl > 0.0 && xh < HUGE_VAL)
+      xn = sqrt(xl*xh);
+    dx = log(xn/x);
+    x = xn;
+    if(fabs(dx) < 1.0e-12)
+      break;
+  }
+  return(x);
+}
@@ -1,27 +1,128 @@
 /*
  *  double rng_lp(double r, int k)
  *    returns lower probability of the range distribution.
+ *  double rng_lpt(double r, int k, int acc)
+ *    is rng_lp() using nrml_pt() with accuracy 10^(-acc).
+ *  void rng_lpv(const double *r, int n, int k, int acc, double *p)
+ *    stores rng_lpt(r[i], k, acc) in p[i] for i = 0, ..., n-1.
+ *  double rng_lpd(double r, int k, int acc, double *d)
+ *    is rng_lpt() and stores the density of the range in *d.
+ *  void rng_lpdv(const double *r, int n, int k, int acc, double *p,
+ *                double *d)
+ *    is rng_lpv() and stores the densities in d[i].
+ *  void rng_lpk(double r, const int *k, int nk, int acc, double *p)
+ *    stores rng_lpt(r, k[i], acc) in p[i] for i = 0, ..., nk-1
+ *    (approximately; see Note 8).
+ *  double rng_lpa(double r, int k, double tol, double *err)
+ *    is rng_lp() by adaptive Gauss-Kronrod quadrature.
+ *  double rng_up(double r, int k)
+ *    returns upper probability of the range distribution.
+ *  double rng_upt(double r, int k, int acc)
+ *    is rng_up() using nrml_pt() with accuracy 10^(-acc).
  *
  *  Arguments
- *    r: range value
- *    k: number of treatments
+ *    r:   range value (array of n values for rng_lpv)
+ *    n:   number of range values
+ *    p:   array of n probabilities (output)
+ *    d:   density (array of n densities for rng_lpdv) (output).
+ *         It is not stored if d == NULL.
+ *    k:   number of treatments (array of nk values for rng_lpk)
+ *    nk:  number of k values
+ *    acc: accuracy of normal probabilities (see nrml_pt()).
+ *         rng_lp() uses acc=16.
+ *    tol: requested absolute error of rng_lpa() (tol < TOLA,
+ *         including tol <= 0, is taken as TOLA=1e-16)
+ *    err: estimated absolute error of rng_lpa() (output)
  *
  *  Required functions
- *    extern double nrml_p()
- *    static double nrml_ip()
+ *    extern double nrml_pt()
+ *    extern double nrml_lip()
+ *    extern double nrml_ip()
+ *    extern void   nrml_pv()
+ *    extern void   nrml_lipv()
  *    static double ulim()
  *    static double f()
+ *    static double fd()
+ *    static double dtail()
+ *    static double dbeyond()
+ *    static double fu()
+ *    static double gk15()
  *
  *  Include files
  *    <math.h>
+ *    <stddef.h>
  *
  *  Note
  *    1) The 20-node Gauss-Legendre quadrature is used.
+ *       For k > 1000, it is used on 4 subintervals.
  *    2) The accuracy is of order e-12 (I hope).
- *    3) This accuracy is not guaranteed for k > 1000.
+ *    3) The powers of normal probabilities are computed as
+ *       exp((k - 1)*log(p)), and the accuracy is of order e-11
+ *       for k <= 50000.
+ *    4) rng_lpv() collects the nodes of RBLK range values and
+ *       evaluates their normal probabilities with nrml_lipv().
+ *       The results are the same as those of rng_lpt().
+ *    5) rng_lpa() integrates the 2nd term up to x where its tail is
+ *       below tol/4 (instead of ulim()).  It bisects the interval
+ *       with the largest Gauss-Kronrod (7-15) error estimate until
+ *       the total estimate is below tol or NINT intervals are used.
+ *       If *err > tol on return, the requested accuracy was not
+ *       attained.  The estimate does not include the error of
+ *       nrml_p() (up to 5e-14 near |u| = 3.7, which is multiplied
+ *       by about k in rng_lp()).
+ *       About 25 nodes are used for tol=1e-6, 45 for 1e-9 and
+ *       65 for 1e-11.
+ *    6) rng_up() is not 1.0 - rng_lp(), which has no significant
+ *       digits below 1e-12.  Since 1 - [2*Phi(r/2) - 1]^k is the
+ *       probability that max |x_i| > r/2,
+ *         1 - rng_lp(r) = 2k \int_{r/2}^{\infty} phi(x)
+ *                         [A(x)^(k-1) - B(x)^(k-1)] dx,
+ *       where A(x)=Pr{-x < X < x} and B(x)=Pr{x-r < X < x}.  The
+ *       bracket is A^(k-1) * (-expm1((k-1)*log1p(-D/A))) with
+ *       D=A-B=Pr{-x < X < x-r} by nrml_ip(), whose tail form keeps
+ *       the relative accuracy.  For large r, the integrand is about
+ *       exp(-(x-r/2)^2-r^2/4) (1-exp(-r(x-r/2))), so it is integrated
+ *       up to max(r/2+6, xu) (xu as in rng_lpa() with tol=1e-16) on
+ *       subintervals of width 1/r, 4/r, 16/r, ..., up to UWDTH.
+ *       If rng_lp() < 0.5, where A^(k-1) is steep for large k,
+ *       1.0 - rng_lp() is returned instead.  The relative error is
+ *       of order e-12 down to underflow.
+ *    7) The density of the range is
+ *         g(r) = 2k(k-1) \int_{r/2}^{\infty} phi(x) phi(x-r)
+ *                B(x)^(k-2) dx
+ *       (the derivative of the 1st term of Hartley's formula cancels
+ *       that of the lower limit of the 2nd term), and it is summed at
+ *       the same nodes as rng_lpt() from the same nrml_lip() calls.
+ *       The part beyond ulim() is not negligible in the relative
+ *       sense for large r, and it is integrated by the 20-node rule
+ *       up to r/2+DXT on 20 more nodes (dbeyond()).  Beyond r/2+DXT,
+ *       where phi(x) phi(x-r) has less than 1e-13 of its mass,
+ *       B(x)^(k-2) <= B(r/2+DXT)^(k-2) is taken out to leave a
+ *       normal probability (dtail()).  Below rmin(k), where the 2nd
+ *       term is dropped, the density of the 1st term
+ *       k A(r/2)^(k-1) phi(r/2) is stored, whose absolute error is of
+ *       order e-12.  Above rmin(k) the relative error is up to 5e-14
+ *       (k=20), 4e-13 (k=100), 3e-12 (k=1000) and 5e-12 (k=2000)
+ *       for r > 8, and 3e-11 at r=2.5 (k=100).  The 20 more nodes
+ *       make the density about 1.8 times as long as without it.
+ *    8) In Hartley's formula only the power k-1 depends on k, so
+ *       rng_lpk() evaluates the normal interval probabilities once
+ *       at the nodes of the widest ulim() among k[i] (on NSUBK/2
+ *       subintervals, or NSUBK if some k[i] > 1000) and sums
+ *       the powers for each k[i].  The 2nd term is dropped below
+ *       rmin(k[i]) as in rng_lpt().  The nodes differ from those of
+ *       rng_lpt(), but the error is also of order e-12, and a row of
+ *       24 k values (2 to 20, 50 to 1000) takes about 1/4 of the
+ *       time of rng_lpt() calls.  It is an entry point for callers
+ *       that tabulate rng_lp() over k at fixed r, and nothing in this
+ *       package calls it: the r-grid of each column of smrng_tbl.c
+ *       lies on (rlower(k), rupper(k)) of that k, and the quantile
+ *       searches take a different r for each k, so no two k share a
+ *       range value there.
  *
  *  References
  *    H. O. Hartley (1942). Biometrika, 32, 309-310.
+ *    R. Piessens et al. (1983). QUADPACK, Springer.
  *    
  *  Stored in 
  *    rng_lp.c
@@ -31,6 +132,16 @@
  *    2018-11-01: Created with ulim() function.
  *    2019-04-23: Modified for new version.
  *    2021-05-08: Last modified.
+ *    2026-10-16: Accuracy of normal probabilities is selectable.
+ *                nrml_ip() moved to nrml_p.c and shares the density.
+ *                Log probabilities and subintervals for k > 1000.
+ *                rng_lpv() for arrays of range values.
+ *                rng_lpa() with adaptive quadrature.
+ *                rng_up() for upper probability.
+ *                rng_lpd() with the density of the range.
+ *                rng_lpk() for a list of k values on shared nodes.
+ *                Smallest tol of rng_lpa().
+ *                Density integrated beyond ulim() (dbeyond()).
  *
  *  License
  *    GPLv3 (Free and No Warranty)
@@ -41,29 +152,24 @@
 
 
 #include <math.h>
-#define BORDER  3.7
-#define CNST0   0.398942280401432677939946059934381868  // 1/sqrt(2*pi)
+#include <stddef.h>
 #define MAX(X, Y)  ((X < Y) ? Y : X)
 #define MIN(X, Y)  ((X < Y) ? X : Y)
+#define RBLK  16    // number of range values processed at a time
+#define NSUBK 8     // maximum number of subintervals in rng_lpk()
+#define NINT  200   // maximum number of intervals in rng_lpa()
+#define TOLA  1.0e-16 // smallest tol of rng_lpa()
+#define UTOL  1.0e-16 // absolute truncation error of rng_up()
+#define UWDTH 2.0     // maximum width of subintervals in rng_up()
+#define DXT   5.3     // density integrated up to r/2+DXT (Note 7)
+#define CNST0 0.398942280401432677939946059934381868  // 1/sqrt(2*pi)
 
-extern double nrml_p(double u, int upper);
-
-/* Normal probability in interval (a, b).
- */
-static double nrml_ip(double a, double b)
-{
-  double  border=(BORDER);
-
-  if(a >= b)
-    return(0.0);
-
-  if(a > border)
-    return(nrml_p(a, 1) - nrml_p(b, 1));
-  else if(b < -border)
-    return(nrml_p(b, 0) - nrml_p(a, 0));
-  else
-    return(nrml_p(b, 2) - nrml_p(a, 2));
-}
+extern double nrml_pt(double u, int upper, int acc);
+extern double nrml_lip(double a, double b, int acc, double *dens);
+extern double nrml_ip(double a, double b, int acc, double *dens);
+extern void nrml_pv(const double *u, int n, int upper, int acc, double *p);
+extern void nrml_lipv(const double *a, const double *b, int n, int acc,
+                      double *lp, double *db);
 
 /* Upper integral limit for Hartley's formula.
  * The limit depends on both r and k.
@@ -72,10 +178,6 @@ static double ulim(double r, int k)
 {
   double w=log((double)k), ulim13, rmin, rmin10, a1, a2, a3, d1, d2, z;
 
-  // If k > 1000, use the value for k=1000.
-  if(k > 1000) 
-    k = 1000;
-
   // Approximate upper limit at r=13.
   ulim13 = 1.403*sqrt(w + 28.127);
 
@@ -85,6 +187,10 @@ static double ulim(double r, int k)
   if(r <= rmin)
     return(0.0);
 
+  // If k > 1000, use the limit at r=13 (with subintervals).
+  if(k > 1000)
+    return(ulim13);
+
   // Upper integral limit depending on whether k <= 10 or k > 10.
   if(k <= 10) {
     d1 = 0.02173*log(8.7/(k - 1.3));
@@ -105,66 +211,519 @@ static double ulim(double r, int k)
 }
 
 /* Integrand function
+ * The normal density at x comes with the log interval probability.
  */
-static double f(double x, double r, int k)
+static double f(double x, double r, int k, int acc)
 {
-  double y = exp(-0.5*x*x) * pow(nrml_ip(x - r, x), k - 1);
+  double dens[2], y;
+
+  y = nrml_lip(x - r, x, acc, dens);
+  y = dens[1] * exp((k - 1)*y);
   return(y);
 }
 
-double rng_lp(double r, int k)
+/* f() and the integrand of the density
+ *   phi(x) phi(x-r) B^(k-2),  B=Pr{x-r<X<x}
+ * in *g.
+ */
+static double fd(double x, double r, int k, int acc, double *g)
 {
-  // 20 nodes and weights for Gauss-Legendre quadrature.
-  const double nd[10]={
-    0.993128599185094924786122388471320278,
-    0.963971927277913791267666131197277222,
-    0.912234428251325905867752441203298113,
-    0.839116971822218823394529061701520685,
-    0.746331906460150792614305070355641590,
-    0.636053680726515025452836696226285937,
-    0.510867001950827098004364050955250998,
-    0.373706088715419560672548177024927237,
-    0.227785851141645078080496195368574625,
-    0.0765265211334973337546404093988382110
-  };
-  const double wt[10]={
-    0.0176140071391521183118619623518528164,
-    0.0406014298003869413310399522749321099,
-    0.0626720483341090635695065351870416064,
-    0.0832767415767047487247581432220462061,
-    0.101930119817240435036750135480349876,
-    0.118194531961518417312377377711382287,
-    0.131688638449176626898494499748163135,
-    0.142096109318382051329298325067164933,
-    0.149172986472603746787828737001969437,
-    0.152753387130725850698084331955097593
-  };
+  double dens[2], y;
+
+  y = nrml_lip(x - r, x, acc, dens);
+  *g = dens[0] * dens[1] * exp((k - 2)*y);
+  return(dens[1] * exp((k - 1)*y));
+}
 
-  double  xu, p=0.0, cntr, wdth, x;
+/* Density of the 2nd term beyond t=max(xu, r/2),
+ *   2k(k-1) B(t)^(k-2) \int_t^{\infty} phi(x) phi(x-r) dx,
+ * since B(x) <= B(t) (and B(x) is nearly 1 for large r).
+ * lb is log(B(t)).
+ */
+static double dtail(double r, int k, double t, double lb, int acc)
+{
+  return(sqrt(2.0)*k*(k - 1)*(CNST0)*exp(-0.25*r*r + (k - 2)*lb)
+         * nrml_pt(sqrt(2.0)*(t - 0.5*r), 1, acc));
+}
+
+/* Integrand function of rng_up()
+ *   phi(x) [A^(k-1) - B^(k-1)],  A=Pr{-x<X<x}, B=A-Pr{-x<X<x-r}
+ */
+static double fu(double x, double r, int k, int acc)
+{
+  double dens[2], la, d;
+
+  la = nrml_lip(-x, x, acc, dens);
+  d = nrml_ip(-x, x - r, acc, NULL);
+  return(dens[1] * exp((k - 1)*la) * (-expm1((k - 1)*log1p(-d*exp(-la)))));
+}
+
+/* 20 nodes and weights for Gauss-Legendre quadrature.
+ */
+static const double nd[10]={
+  0.993128599185094924786122388471320278,
+  0.963971927277913791267666131197277222,
+  0.912234428251325905867752441203298113,
+  0.839116971822218823394529061701520685,
+  0.746331906460150792614305070355641590,
+  0.636053680726515025452836696226285937,
+  0.510867001950827098004364050955250998,
+  0.373706088715419560672548177024927237,
+  0.227785851141645078080496195368574625,
+  0.0765265211334973337546404093988382110
+};
+static const double wt[10]={
+  0.0176140071391521183118619623518528164,
+  0.0406014298003869413310399522749321099,
+  0.0626720483341090635695065351870416064,
+  0.0832767415767047487247581432220462061,
+  0.101930119817240435036750135480349876,
+  0.118194531961518417312377377711382287,
+  0.131688638449176626898494499748163135,
+  0.142096109318382051329298325067164933,
+  0.149172986472603746787828737001969437,
+  0.152753387130725850698084331955097593
+};
+
+/* Density of the 2nd term beyond t >= r/2,
+ *   2k(k-1) \int_t^{\infty} phi(x) phi(x-r) B(x)^(k-2) dx,
+ * by the 20-node rule on (t, r/2+DXT) and dtail() beyond.
+ */
+static double dbeyond(double r, int k, double t, int acc)
+{
+  double  tu=MAX(t, 0.5*r + DXT), cntr, wdth, x, g1, g2, d1=0.0;
   int     ix;
 
+  if(t < tu) {
+    cntr = 0.5*(t + tu);
+    wdth = 0.5*(tu - t);
+    for(ix=0; ix < 10; ix++) {
+      x = wdth*nd[ix];
+      fd(cntr - x, r, k, acc, &g1);
+      fd(cntr + x, r, k, acc, &g2);
+      d1 += wt[ix] * (g1 + g2);
+    }
+    d1 *= 2.0*k*(k - 1)*wdth;
+  }
+  return(d1 + dtail(r, k, tu, nrml_lip(tu - r, tu, acc, NULL), acc));
+}
+
+double rng_lpd(double r, int k, int acc, double *d)
+{
+  double  xu, xl, p=0.0, p1, d1, cntr, wdth, x, g1, g2, y;
+  int     ix, j, nsub;
+
+  if(d != NULL)
+    *d = 0.0;
   if(r <= 0.0)
     return(0.0);
 
   // Normal probability.
-  if(k == 2)
-    return(2.0*nrml_p(r/sqrt(2.0), 2));
+  if(k == 2) {
+    if(d != NULL)
+      *d = sqrt(2.0)*(CNST0)*exp(-0.25*r*r);
+    return(2.0*nrml_pt(r/sqrt(2.0), 2, acc));
+  }
   
   // Upper integral limit.
   xu = ulim(r, k);
 
   // 2nd term of Hartley's formula.
   if(xu > 0.5*r) {
-    wdth = 0.5*(xu - 0.5*r);
-    cntr = 0.5*(xu + 0.5*r);
+    nsub = (k > 1000) ? 4 : 1;
+    wdth = 0.5*(xu - 0.5*r)/nsub;
+    d1 = 0.0;
+    for(j=0; j < nsub; j++) {
+      xl = 0.5*r + 2.0*j*wdth;
+      cntr = xl + wdth;
+      p1 = 0.0;
+      for(ix=0; ix < 10; ix++) {
+        x = wdth*nd[ix];
+        if(d == NULL)
+          p1 += wt[ix] * (f(cntr - x, r, k, acc) + f(cntr + x, r, k, acc));
+        else {
+          p1 += wt[ix] * (fd(cntr - x, r, k, acc, &g1)
+                          + fd(cntr + x, r, k, acc, &g2));
+          d1 += wt[ix] * (g1 + g2);
+        }
+      }
+      p += p1;
+    }
+    p *= 2.0*k*wdth;
+    if(d != NULL)
+      *d = 2.0*k*(k - 1)*wdth*d1
+        + dbeyond(r, k, xu, acc);
+  }
+
+  // Add 1st term.  Below rmin(k), the density is that of the 1st term.
+  y = nrml_lip(-0.5*r, 0.5*r, acc, NULL);
+  if(d != NULL && xu <= 0.5*r)
+    *d = (xu > 0.0) ? dbeyond(r, k, 0.5*r, acc)
+      : k*(CNST0)*exp(-0.125*r*r + (k - 1)*y);
+  p += exp(k * y);
+  return(p);
+}
+
+double rng_lpt(double r, int k, int acc)
+{
+  return(rng_lpd(r, k, acc, NULL));
+}
+
+double rng_lp(double r, int k)
+{
+  return(rng_lpt(r, k, 16));
+}
+
+void rng_lpdv(const double *r, int n, int k, int acc, double *p, double *d)
+{
+  // Structure of arrays for all nodes of RBLK range values.
+  double  a[RBLK*100], b[RBLK*100], lp[RBLK*100], db[RBLK*100];
+  double  gd[RBLK*100], a1[RBLK], b1[RBLK], lp1[RBLK], wdth[RBLK];
+  double  xu[RBLK], a2[RBLK], b2[RBLK], lp2[RBLK], wd2[RBLK];
+  double  cntr, x, p1, d1, d2;
+  int     nn[RBLK], ne[RBLK], nsub=(k > 1000) ? 4 : 1, i, j, ix, l, le, m;
+
+  for( ; n > 0; n -= m, r += m, p += m) {
+    m = (n < RBLK) ? n : RBLK;
+
+    // Normal probability.
+    if(k == 2) {
+      for(i=0; i < m; i++)
+        a1[i] = r[i]/sqrt(2.0);
+      nrml_pv(a1, m, 2, acc, p);
+      for(i=0; i < m; i++)
+        p[i] = (r[i] <= 0.0) ? 0.0 : 2.0*p[i];
+      if(d != NULL) {
+        for(i=0; i < m; i++)
+          d[i] = (r[i] <= 0.0) ? 0.0 : sqrt(2.0)*(CNST0)*exp(-0.25*r[i]*r[i]);
+        d += m;
+      }
+      continue;
+    }
+
+    // Nodes of the 2nd term and intervals of the 1st term.
+    for(i=0, l=0; i < m; i++) {
+      nn[i] = ne[i] = 0;
+      a1[i] = -0.5*r[i];
+      b1[i] = 0.5*r[i];
+      xu[i] = 0.0;
+      if(r[i] <= 0.0)
+        continue;
+      xu[i] = ulim(r[i], k);
+      if(xu[i] <= 0.0)
+        continue;
+      // Nodes of dbeyond() on (max(xu, r/2), r/2+DXT).
+      cntr = MAX(xu[i], 0.5*r[i]);
+      b2[i] = MAX(cntr, 0.5*r[i] + DXT);
+      a2[i] = b2[i] - r[i];
+      if(d != NULL && cntr < b2[i]) {
+        ne[i] = 20;
+        wd2[i] = 0.5*(b2[i] - cntr);
+        cntr += wd2[i];
+        for(ix=0; ix < 10; ix++, l += 2) {
+          x = wd2[i]*nd[ix];
+          b[l] = cntr - x;
+          b[l+1] = cntr + x;
+          a[l] = b[l] - r[i];
+          a[l+1] = b[l+1] - r[i];
+        }
+      }
+      if(xu[i] <= 0.5*r[i])
+        continue;
+      nn[i] = 20*nsub;
+      wdth[i] = 0.5*(xu[i] - 0.5*r[i])/nsub;
+      for(j=0; j < nsub; j++) {
+        cntr = 0.5*r[i] + 2.0*j*wdth[i] + wdth[i];
+        for(ix=0; ix < 10; ix++, l += 2) {
+          x = wdth[i]*nd[ix];
+          b[l] = cntr - x;
+          b[l+1] = cntr + x;
+          a[l] = b[l] - r[i];
+          a[l+1] = b[l+1] - r[i];
+        }
+      }
+    }
+    nrml_lipv(a, b, l, acc, lp, db);
+    nrml_lipv(a1, b1, m, acc, lp1, NULL);
+    if(d != NULL) {
+      for(ix=0; ix < l; ix++)
+        gd[ix] = (CNST0)*exp(-0.5*a[ix]*a[ix]) * db[ix] * exp((k - 2)*lp[ix]);
+      // log(B) at the end of the nodes of dbeyond().
+      for(i=0; i < m; i++) {
+        if(r[i] <= 0.0 || xu[i] <= 0.0)
+          a2[i] = b2[i] = 0.0;
+      }
+      nrml_lipv(a2, b2, m, acc, lp2, NULL);
+    }
+    for(ix=0; ix < l; ix++)
+      lp[ix] = db[ix] * exp((k - 1)*lp[ix]);
+
+    // Sum up in the same order as rng_lpd().
+    for(i=0, l=0; i < m; i++) {
+      p[i] = 0.0;
+      d1 = 0.0;
+      if(r[i] <= 0.0) {
+        if(d != NULL)
+          d[i] = 0.0;
+        continue;
+      }
+      le = l;
+      l += ne[i];
+      if(nn[i] > 0) {
+        for(j=0; j < nsub; j++) {
+          p1 = 0.0;
+          for(ix=0; ix < 10; ix++, l += 2) {
+            p1 += wt[ix] * (lp[l] + lp[l+1]);
+            if(d != NULL)
+              d1 += wt[ix] * (gd[l] + gd[l+1]);
+          }
+          p[i] += p1;
+        }
+        p[i] *= 2.0*k*wdth[i];
+        d1 *= 2.0*k*(k - 1)*wdth[i];
+      }
+      p[i] += exp(k * lp1[i]);
+      if(d == NULL)
+        continue;
+      if(xu[i] <= 0.0) {
+        d[i] = k*(CNST0)*exp(-0.125*r[i]*r[i] + (k - 1)*lp1[i]);
+        continue;
+      }
+      // dbeyond() from the nodes after those of the 2nd term.
+      d2 = 0.0;
+      if(ne[i] > 0) {
+        for(ix=0; ix < 10; ix++)
+          d2 += wt[ix] * (gd[le + 2*ix] + gd[le + 2*ix + 1]);
+        d2 *= 2.0*k*(k - 1)*wd2[i];
+      }
+      d[i] = d1 + (d2 + dtail(r[i], k, b2[i], lp2[i], acc));
+    }
+    if(d != NULL)
+      d += m;
+  }
+}
+
+void rng_lpv(const double *r, int n, int k, int acc, double *p)
+{
+  rng_lpdv(r, n, k, acc, p, NULL);
+}
+
+void rng_lpk(double r, const int *k, int nk, int acc, double *p)
+{
+  double  a[NSUBK*20], b[NSUBK*20], lp[NSUBK*20], db[NSUBK*20];
+  double  xu=0.0, wdth, cntr, x, y, p1;
+  int     nsub=1, i, j, ix, l;
+
+  if(r <= 0.0) {
+    for(i=0; i < nk; i++)
+      p[i] = 0.0;
+    return;
+  }
+
+  // Widest upper limit among k > 2.
+  for(i=0; i < nk; i++) {
+    if(k[i] > 2)
+      xu = MAX(xu, ulim(r, k[i]));
+    if(k[i] > 1000)
+      nsub = NSUBK;
+  }
+
+  // Shared nodes of the 2nd term.
+  l = 0;
+  if(xu > 0.5*r) {
+    if(nsub == 1)
+      nsub = NSUBK/2;
+    wdth = 0.5*(xu - 0.5*r)/nsub;
+    for(j=0; j < nsub; j++) {
+      cntr = 0.5*r + 2.0*j*wdth + wdth;
+      for(ix=0; ix < 10; ix++, l += 2) {
+        x = wdth*nd[ix];
+        b[l] = cntr - x;
+        b[l+1] = cntr + x;
+        a[l] = b[l] - r;
+        a[l+1] = b[l+1] - r;
+      }
+    }
+    nrml_lipv(a, b, l, acc, lp, db);
+  }
+  y = nrml_lip(-0.5*r, 0.5*r, acc, NULL);
+
+  for(i=0; i < nk; i++) {
+    if(k[i] == 2) {
+      p[i] = 2.0*nrml_pt(r/sqrt(2.0), 2, acc);
+      continue;
+    }
+    p[i] = 0.0;
+    // The 2nd term is dropped below rmin(k[i]) as in rng_lpt().
+    if(l > 0 && ulim(r, k[i]) > 0.5*r) {
+      for(j=0, ix=0; j < nsub; j++) {
+        p1 = 0.0;
+        for( ; ix < 20*(j + 1); ix += 2)
+          p1 += wt[(ix/2)%10] * (db[ix]*exp((k[i] - 1)*lp[ix])
+                                 + db[ix+1]*exp((k[i] - 1)*lp[ix+1]));
+        p[i] += p1;
+      }
+      p[i] *= 2.0*k[i]*wdth;
+    }
+    p[i] += exp(k[i] * y);
+  }
+}
+
+/* 15-point Kronrod rule on (a, b) with the error estimate
+ * from the embedded 7-point Gauss rule.
+ */
+static double gk15(double a, double b, double r, int k, double *err)
+{
+  const double xgk[8]={
+    0.991455371120812639206854697526329,
+    0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926,
+    0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013,
+    0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245,
+    0.0
+  };
+  const double wgk[8]={
+    0.022935322010529224963732008058970,
+    0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518,
+    0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550,
+    0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649,
+    0.209482141084727828012999174891714
+  };
+  const double wg[4]={
+    0.129484966168869693270611432679082,
+    0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975,
+    0.417959183673469387755102040816327
+  };
+  double  cntr=0.5*(a + b), wdth=0.5*(b - a), fc, f2, rk, rg;
+  int     i;
+
+  fc = f(cntr, r, k, 16);
+  rk = wgk[7]*fc;
+  rg = wg[3]*fc;
+  for(i=0; i < 7; i++) {
+    f2 = f(cntr - wdth*xgk[i], r, k, 16) + f(cntr + wdth*xgk[i], r, k, 16);
+    rk += wgk[i]*f2;
+    if(i%2 == 1)
+      rg += wg[i/2]*f2;
+  }
+  *err = fabs((rk - rg)*wdth);
+  return(rk*wdth);
+}
+
+double rng_lpa(double r, int k, double tol, double *err)
+{
+  double  a[NINT], b[NINT], p[NINT], e[NINT];
+  double  xu, c, ptot, etot, emax;
+  int     n, i, imax=0;
+
+  *err = 0.0;
+  if(r <= 0.0)
+    return(0.0);
+
+  // Normal probability.
+  if(k == 2)
+    return(2.0*nrml_pt(r/sqrt(2.0), 2, 16));
+
+  // 2k \int_xu^\infty phi(x) dx < 2k phi(xu) < tol/4 for xu >= 1.
+  tol = MAX(tol, TOLA);
+  xu = sqrt(2.0*log(8.0*k*(CNST0)/tol));
+  xu = MAX(xu, 1.0);
+
+  ptot = exp(k * nrml_lip(-0.5*r, 0.5*r, 16, NULL));
+  if(xu <= 0.5*r) {
+    *err = 2.0*k*(CNST0)*exp(-0.125*r*r);
+    return(ptot);
+  }
+
+  a[0] = 0.5*r;
+  b[0] = xu;
+  p[0] = gk15(a[0], b[0], r, k, &e[0]);
+  n = 1;
+
+  for(;;) {
+    etot = 0.0;
+    emax = -1.0;
+    for(i=0; i < n; i++) {
+      etot += e[i];
+      if(e[i] > emax) {
+        emax = e[i];
+        imax = i;
+      }
+    }
+    if(2.0*k*etot <= 0.75*tol || n >= NINT)
+      break;
+
+    // Bisect the interval with the largest error.
+    c = 0.5*(a[imax] + b[imax]);
+    a[n] = c;
+    b[n] = b[imax];
+    b[imax] = c;
+    p[imax] = gk15(a[imax], b[imax], r, k, &e[imax]);
+    p[n] = gk15(a[n], b[n], r, k, &e[n]);
+    n++;
+  }
+
+  for(i=0; i < n; i++)
+    ptot += 2.0*k*p[i];
+  *err = 2.0*k*etot + 2.0*k*(CNST0)*exp(-0.5*xu*xu);
+  return(ptot);
+}
+
+double rng_upt(double r, int k, int acc)
+{
+  double  xu, xl, p=0.0, p1, cntr, wdth, w, x, ub;
+  int     ix;
+
+  if(r <= 0.0)
+    return(1.0);
+
+  // Normal probability.
+  if(k == 2)
+    return(2.0*nrml_pt(r/sqrt(2.0), 1, acc));
+
+  // Bonferroni bound k(k-1) Pr{|x_1 - x_2| > r}, which underflows
+  // for r > 55 or so.  1.0 - rng_lp() is accurate enough if
+  // rng_lp() < 0.5, which needs the bound > 0.5.
+  ub = k*(k - 1.0)*nrml_pt(r/sqrt(2.0), 1, acc);
+  if(ub == 0.0)
+    return(0.0);
+  if(ub > 0.5) {
+    p = rng_lpt(r, k, acc);
+    if(p < 0.5)
+      return(1.0 - p);
+    p = 0.0;
+  }
+
+  // 2k \int_xu^\infty phi(x) dx < UTOL, or 6 beyond the peak at r/2.
+  xu = sqrt(2.0*log(8.0*k*(CNST0)/(UTOL)));
+  xu = MAX(xu, 0.5*r + 6.0);
+
+  // The integrand rises like 1-exp(-r*(x-r/2)) from x=r/2, so the
+  // subintervals grow from 1/r by the factor 4 up to UWDTH.
+  xl = 0.5*r;
+  w = 1.0/r;
+  while(xl < xu) {
+    wdth = 0.5*(MIN(xl + MIN(w, UWDTH), xu) - xl);
+    cntr = xl + wdth;
+    p1 = 0.0;
     for(ix=0; ix < 10; ix++) {
       x = wdth*nd[ix];
-      p += wt[ix] * (f(cntr - x, r, k) + f(cntr + x, r, k));
+      p1 += wt[ix] * (fu(cntr - x, r, k, acc) + fu(cntr + x, r, k, acc));
     }
-    p *= 2.0*k*wdth*(CNST0);
+    p += wdth*p1;
+    xl = (2.0*wdth < xu - xl) ? xl + 2.0*wdth : xu;
+    w *= 4.0;
   }
+  return(2.0*k*p);
+}
 
-  // Add 1st term.
-  p += pow(2.0*nrml_p(0.5*r, 2), (double)k);
-  return(p);
+double rng_up(double r, int k)
+{
+  return(rng_upt(r, k, 16));
 }
@@ -0,0 +1,131 @@
+/*
+ *  Test program for rng_lp().
+ *    Command format: ./rng_lp_tst [k [acc]]
+ *
+ *  Arguments
+ *    [k]:   number of treatments (k <= 1 or omitted means
+ *           k = 2, 3, 5, 10, 20, 50, 100, 200, 500, 1000 and 2000)
+ *    [acc]: accuracy of normal probabilities of the vector check
+ *           (16 if omitted)
+ *
+ *  Required functions:
+ *    extern double rng_lp()
+ *    extern double rng_lpt()
+ *    extern double rng_lpd()
+ *    extern void   rng_lpv()
+ *    extern void   rng_lpdv()
+ *    extern void   rng_lpk()
+ *    extern double rng_lpa()
+ *    extern double rng_up()
+ *      extern double nrml_pt()
+ *      extern double nrml_lip()
+ *      extern void   nrml_lipv()
+ *    static void   check()
+ *
+ *  Note
+ *    1) For r = 0.05, 0.10, ..., 12 it checks that
+ *         rng_lpv() and rng_lpdv() are bit-identical to rng_lpt()
+ *           and rng_lpd(),
+ *         rng_lp() + rng_up() = 1 within TOLU*(k+10),
+ *         the density of rng_lpd() agrees with the finite
+ *           difference of rng_lp() within TOLD*(k+10),
+ *         rng_lpa() with tol=1e-14 agrees with rng_lp() within
+ *           TOLA*(k+10),
+ *         rng_lpk() agrees with rng_lp() within TOLK,
+ *       prints the largest differences, and exits with 1 if a check
+ *       fails.
+ *    2) The rounding errors grow in proportion to k.  The largest
+ *       differences measured are 2.3e-11, 5.7e-8 and 4.2e-12 at
+ *       k=2000, and 1.5e-13, 1.4e-10 and 1.0e-13 at k=3, for the
+ *       three scaled checks.  The tolerances are about twice them.
+ *    3) The finite difference is the 5-point one with h=DH, whose
+ *       error is of order h^4 plus 1e-13/h from the rounding of
+ *       rng_lp().
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#define NR    240     // number of range values
+#define DH    1.0e-3  // step of the finite difference
+#define TOLU  2.0e-14 // rng_lp() + rng_up() - 1, times (k+10)
+#define TOLD  1.0e-10 // density - finite difference, times (k+10)
+#define TOLA  1.0e-14 // rng_lpa() - rng_lp(), times (k+10)
+#define TOLK  1.0e-11 // rng_lpk() - rng_lp()
+
+extern double rng_lp(double r, int k);
+extern double rng_lpt(double r, int k, int acc);
+extern double rng_lpd(double r, int k, int acc, double *d);
+extern void rng_lpv(const double *r, int n, int k, int acc, double *p);
+extern void rng_lpdv(const double *r, int n, int k, int acc, double *p,
+                     double *d);
+extern void rng_lpk(double r, const int *k, int nk, int acc, double *p);
+extern double rng_lpa(double r, int k, double tol, double *err);
+extern double rng_up(double r, int k);
+
+static int nfail=0;
+
+static void check(const char *s, double e, double tol)
+{
+  printf("  %-26s %10.3e  %s\n", s, e, (e <= tol) ? "OK" : "NG");
+  if(!(e <= tol))
+    nfail++;
+}
+
+int main(int argc, char **argv)
+{
+  int     kl[11]={2, 3, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+  int     nk=11, acc=16, i, j, nv;
+  double  r[NR], p[NR], d[NR], pk[11], x, y, fd, err;
+  double  eu, ed, ea, ek;
+
+  if(argc >= 2 && atoi(argv[1]) > 1) {
+    kl[0] = atoi(argv[1]);
+    nk = 1;
+  }
+  if(argc >= 3)
+    acc = atoi(argv[2]);
+  for(i=0; i < NR; i++)
+    r[i] = 0.05*(i + 1);
+
+  for(j=0, ek=0.0; j < nk; j++) {
+    printf("k = %i\n", kl[j]);
+    rng_lpv(r, NR, kl[j], acc, p);
+    for(i=0, nv=0; i < NR; i++)
+      nv += (p[i] != rng_lpt(r[i], kl[j], acc));
+    rng_lpdv(r, NR, kl[j], acc, p, d);
+    for(i=0; i < NR; i++) {
+      x = rng_lpd(r[i], kl[j], acc, &y);
+      nv += (p[i] != x || d[i] != y);
+    }
+    check("vector - scalar (count)", (double)nv, 0.0);
+
+    eu = ed = ea = 0.0;
+    for(i=0; i < NR; i++) {
+      x = rng_lp(r[i], kl[j]);
+      eu = fmax(eu, fabs(x + rng_up(r[i], kl[j]) - 1.0));
+      rng_lpd(r[i], kl[j], 16, &y);
+      fd = (8.0*(rng_lp(r[i] + DH, kl[j]) - rng_lp(r[i] - DH, kl[j]))
+            - (rng_lp(r[i] + 2.0*DH, kl[j]) - rng_lp(r[i] - 2.0*DH, kl[j])))
+        /(12.0*DH);
+      ed = fmax(ed, fabs(y - fd));
+      ea = fmax(ea, fabs(rng_lpa(r[i], kl[j], 1.0e-14, &err) - x));
+    }
+    check("lp + up - 1", eu, TOLU*(kl[j] + 10));
+    check("density - difference", ed, TOLD*(kl[j] + 10));
+    check("rng_lpa - rng_lp", ea, TOLA*(kl[j] + 10));
+  }
+
+  printf("k list\n");
+  for(i=0; i < NR; i++) {
+    rng_lpk(r[i], kl, nk, 16, pk);
+    for(j=0; j < nk; j++)
+      ek = fmax(ek, fabs(pk[j] - rng_lp(r[i], kl[j])));
+  }
+  check("rng_lpk - rng_lp", ek, TOLK);
+
+  printf("%s\n", (nfail == 0) ? "All checks passed." : "Some checks failed.");
+  exit ((nfail == 0) ? 0 : 1);
+}
@@ -1,25 +1,119 @@
 /*
- *  double smrng_lp(double q, int k, int df, int nrng)
+ *  double smrng_lp(double q, int k, double df, int nrng)
  *    returns lower probability of
  *    the Studentised maximum range distribution.
+ *  double smrng_lpt(double q, int k, double df, int nrng, int acc)
+ *    is smrng_lp() using rng_lpt() with accuracy 10^(-acc).
+ *  double smrng_lpc(double q, int k, double df, int nrng)
+ *    is smrng_lp() using the interpolant rng_lpc() of rng_lp().
+ *  double smrng_lpd(double q, int k, double df, int nrng, double *pdf)
+ *    is smrng_lp() and stores the density in *pdf.
+ *  double smrng_pdf(double q, int k, double df, int nrng)
+ *    returns the density of
+ *    the Studentised maximum range distribution.
+ *  double smrng_up(double q, int k, double df, int nrng)
+ *    returns upper probability (p-value) of
+ *    the Studentised maximum range distribution.
+ *  double smrng_upt(double q, int k, double df, int nrng, int acc)
+ *    is smrng_up() using rng_upt() with accuracy 10^(-acc).
+ *  double smrng_lpe(double q, int k, double df, int nrng, double eps)
+ *    is smrng_lp() with absolute error eps (see Note 12).
+ *  void smrng_lpn(double q, int k, double df, const int *nrng, int nn,
+ *                 double *p)
+ *    stores smrng_lp(q, k, df, nrng[i]) in p[i] for i = 0, ..., nn-1
+ *    from shared range probabilities (see Note 13).
+ *  void smrng_lpf(double q, int k, const double *df, int ndf,
+ *                 int nrng, double *p)
+ *    stores smrng_lp(q, k, df[i], nrng) in p[i] for i = 0, ..., ndf-1
+ *    on a common r-grid (see Note 14).
+ *
+ *  void smrng_plan_init(struct smrng_plan *pl, int k, double df,
+ *                       int nrng, int acc, int mode)
+ *    sets the plan *pl (such as a local variable) for (k, df, nrng).
+ *  struct smrng_plan *smrng_plan_new(int k, double df, int nrng,
+ *                                    int acc, int mode)
+ *    returns a plan for (k, df, nrng) (NULL if no memory).
+ *  double smrng_plan_lp(struct smrng_plan *pl, double q)
+ *    returns lower probability at q by the plan.
+ *  double smrng_plan_lpd(struct smrng_plan *pl, double q, double *pdf)
+ *    is smrng_plan_lp() and stores the density at q in *pdf.
+ *  double smrng_plan_up(struct smrng_plan *pl, double q)
+ *    returns upper probability at q by the plan.
+ *  double smrng_plan_upd(struct smrng_plan *pl, double q, double *pdf)
+ *    is smrng_plan_up() and stores the density at q in *pdf.
+ *  void smrng_plan_free(struct smrng_plan *pl)
+ *    frees the plan.
+ *  void smrng_plan_par(const struct smrng_plan *pl, int *k, double *df,
+ *                      int *nrng)
+ *    stores (k, df, nrng) of the plan.
+ *  void smrng_plan_eps(struct smrng_plan *pl, double eps)
+ *    sets absolute error eps of the plan (see Note 12).
+ *  void smrng_plan_df(struct smrng_plan *pl, double df)
+ *    changes df of the plan and keeps its r-grid (see Note 14).
  *
  *  Arguments
  *    q:    Studentised maximum range value
  *    k:    number of treatments for each range
- *    df:   error degrees of freedom (df<=0 means df=infinity)
- *    nrng: number of independent ranges
+ *    df:   error degrees of freedom (df<=0 means df=infinity),
+ *          which need not be an integer (array of ndf values for
+ *          smrng_lpf)
+ *    ndf:  number of df values (nothing is done for ndf < 1)
+ *    nrng: number of independent ranges (array of nn values for
+ *          smrng_lpn, where nrng[i] < 1 is skipped and p[i] = -1.0)
+ *    nn:   number of nrng values (nothing is done for nn < 1)
+ *    p:    array of nn (ndf for smrng_lpf) probabilities (output)
+ *    acc:  accuracy of normal probabilities (see nrml_pt()).
+ *          smrng_lp(), smrng_lpd() and smrng_up() use acc=16.
+ *    mode: sum of the following flags
+ *            1 -> rng_lpc() instead of rng_lpt()
+ *            2 -> range probabilities on the r-grid (see Note 7)
+ *            4 -> large-df expansion if accurate (see Note 9)
+ *          smrng_lpt() and smrng_lpd() use mode=4 and smrng_lpc()
+ *          mode=5.
+ *          smrng_plan_up() does not depend on mode.
+ *    pl:   plan made by smrng_plan_new() or smrng_plan_init()
+ *    pdf:  density (output).  It is not stored if pdf == NULL.
+ *    eps:  absolute error required (eps > 0)
  *
  *  Required functions
- *    extern double rng_lp()
+ *    extern double rng_lpt()
+ *    extern void   rng_lpv()
+ *    extern double rng_lpd()
+ *    extern void   rng_lpdv()
+ *    extern double rng_lpc()
+ *    extern double rng_upt()
+ *    extern double chi2_p()
+ *    extern double chi2_q()
+ *    extern double nrml_q()
+ *    extern double stirlerr()
  *    static double rupper()
  *    static double rlower()
  *    static double chi2u()
  *    static double chi2l()
  *    static double coef()
  *    static double f()
+ *    static double fd()
+ *    static double chi()
+ *    static void   plan_df()
+ *    static void   plan_init()
+ *    static void   plan_g()
+ *    static int    grid()
+ *    static void   gauss()
+ *    static double gerr()
+ *    static double asym()
+ *    static int    asyok()
+ *    static int    rule()
+ *    static double fu()
+ *    static double gk15()
+ *    static double adapt()
+ *    static int    slim()
+ *    static int    nodes()
+ *    static double gsum()
  *
  *  Include files
  *    <math.h>
+ *    <stdlib.h>
+ *    "smrng_plan.h"
  *
  *  References
  *    Copenhaver, M. D. and B. Holland (1988).
@@ -32,7 +126,141 @@
  *    1) The 40-node Gauss-Legendre quadrature is used.
  *    2) The accuracy is of order e-11 or more (I hope).
  *    3) This accuracy is not guaranteed for k > 1000 or nrng > 100.
- *    4) Integrates twice if ru/q < su (ru: upper limit of max range).
+ *    4) If ru/q < su (ru: upper limit of max range), the integral
+ *       over (ru/q, su), where rng_lp()=1, is the upper probability
+ *       of chi^2(df) at df*(ru/q)^2 and is given by chi2_p().
+ *    5) smrng_lpc() pays 512 calls of rng_lp() to build the
+ *       interpolant at the first call for each k.  It is faster than
+ *       smrng_lp() after about 15 calls with the same k.  The range
+ *       probabilities of rng_lpc() and rng_lp() differ by up to
+ *       8e-11 for k <= 1000 (Note 2 of rng_lpc.c), and the power
+ *       nrng multiplies the difference by up to nrng.  smrng_lpc()
+ *       and smrng_lp() differ by up to 1.3e-11 for nrng=1, 4.4e-11
+ *       for nrng=10 and 1.5e-10 for nrng=100 (k=2 to 1000, df=1 to
+ *       infinity).
+ *    6) A plan keeps the integral limits, coef(df) and the chi
+ *       densities at the nodes on (sl, su), which do not depend on
+ *       q.  The densities are used when neither the lower nor the
+ *       upper limit of max range cuts (sl, su).  Evaluate a plan
+ *       many times for different q, as smrng_lq() does.
+ *    7) With mode & 2, the inner integral is taken over the max range
+ *       r=s*q instead of s, on NPNL panels of (rl, ru) which do not
+ *       depend on q.  rng_lp(r)^nrng at the nodes of a panel is
+ *       computed at the first use and kept in the plan, so that
+ *       repeated calls (a quantile search) only pay the chi
+ *       densities.  The integral over s is used if the chi density
+ *       covers less than 4 panels (small q).
+ *    8) For fractional df < DFFRAC, chi(s) ~ s^(df-1) is not smooth at
+ *       s=0, and the 40-node quadrature on (sl, su) has errors up to
+ *       1e-5 (df=0.5, k=2), where rl/q does not cut it.  The lower
+ *       probability is then integrated by adapt(), adaptive
+ *       Gauss-Kronrod (7-15) quadrature from NUP0 geometric intervals,
+ *       which resolve the end point.
+ *    9) With mode & 4 and df >= DFASY, E[F(q*s)], F=rng_lp()^nrng, is
+ *       expanded around the df=infinity value F(q) in the moments of
+ *       chi^2/df-1, whose j-th cumulant is of order 1/df^(j-1).  The
+ *       terms up to the 11th moment are summed by the Gauss rule for
+ *       these moments, which needs F at 6 points near q and does not
+ *       amplify the rounding errors of F as the differentiation
+ *       would.  With the 4- and 5-point rules for the error estimate,
+ *       15 values of F are taken by one call of rng_lpv() instead of
+ *       40.  The expansion is used if the error estimate is less than
+ *       tol = max(10^(-acc), ASYEPS) (eps/2 with eps, Note 12).  It is
+ *       accepted at most quantile points (p = 0.1 to 0.999) only for
+ *         df >= ASYDF (k*nrng)^0.6 (tol/ASYEPS)^(-1/6),
+ *       e.g. df >= 610 for k=2 and nrng=1, 1600 for k=10 and 6300 for
+ *       k=10 and nrng=10 (tol=1e-12), and it is not tried below, where
+ *       the 15 values would be wasted.  Over k=2 to 20, nrng=1 and 10
+ *       and df=150 to 1e5, smrng_lp() takes about 0.40 and smrng_lq()
+ *       about 0.57 of the time of mode=0 where the expansion is tried,
+ *       and the time of mode=0 (within 1%) elsewhere.
+ *   10) smrng_up() is not 1.0 - smrng_lp(), which has no significant
+ *       digits below 1e-12.  It integrates chi(s) [1 - F(q*s)] with
+ *         1 - F(r) = -expm1(nrng*log1p(-rng_up(r, k))).
+ *       On (0, rl/q), where F=0, the integral is the lower
+ *       probability of chi^2(df) at df*(rl/q)^2 by chi2_p().  The
+ *       limit rl/q replaces sl, since the mass of s for a small
+ *       p-value may lie below sl, and ru/q is not used, since F < 1
+ *       there.  The rest on (rl/q, su) is integrated by adapt(),
+ *       adaptive Gauss-Kronrod (7-15) quadrature from NUP0 geometric
+ *       intervals until the error estimate is below max(10^(-acc),
+ *       UREL) times the result (or NINTU intervals are used), so the
+ *       relative error is below 2.2e-11 (against UREL=1e-14, k=2 to
+ *       1000, df=1 to 1e7, nrng=1 to 100, q=3 to 30) down to 1e-300
+ *       or so.  UREL=1e-12 takes about 2.5 times as long and gains
+ *       nothing below, since smrng_lp()+smrng_up()-1 comes from the
+ *       40-node rule of smrng_lp() (Note 1) at steep F=rng_lp()^nrng:
+ *       it is up to 1.2e-11 for nrng=1, 3.2e-11 for nrng=10 and
+ *       1.4e-10 for nrng=100 (k=100, df=240, q=7) over k=2 to 1000,
+ *       df=1 to 1e7 and q=2 to 12.  For large df, chi() sums the
+ *       deviance near s=1, since (df-1) log(s) + df (1-s^2)/2 loses
+ *       the rounding of s^2 times df (1.6e-10 at df=1e7).  The mass
+ *       beyond su is less than 0.5e-13 times the result, since 1-F
+ *       is decreasing.
+ *       smrng_up() takes about 80 times as long as smrng_lp().
+ *   11) The density is the derivative in q under the integral,
+ *         cnst \int chi(s) s F'(q*s) ds,
+ *         F'(r) = nrng rng_lp(r)^(nrng-1) g(r),
+ *       with the range density g(r) by rng_lpdv() at the same nodes
+ *       (on the r-grid, in the large-df expansion, or on the
+ *       intervals of adapt() for fractional df and smrng_plan_upd()).
+ *       The chi tails cut by rl and ru add nothing.
+ *       F'(r) is kept in the plan next to F(r) on the r-grid.  The
+ *       error estimate of the large-df expansion includes that of the
+ *       density.  rng_lpc() has no density, so mode & 1 takes the
+ *       densities from rng_lpdv() and saves nothing.  The lower
+ *       probability is the same as that of smrng_plan_lp() (except
+ *       when the expansion is rejected for the density).  With the
+ *       range density integrated beyond ulim() (Note 7 of rng_lp.c),
+ *       smrng_lpd() takes about twice the time of smrng_lp().
+ *   12) The limits rlower(), rupper(), chi2l() and chi2u() cut tails
+ *       of 0.5e-13.  smrng_plan_eps() (smrng_lpe()) takes the limits of
+ *       s for chi^2 tails of eps/8 by chi2_q(), and the upper limit of
+ *       max range ru=sqrt(2) z for k(k-1) nrng Q(z)=eps/8 (union bound
+ *       of the pairwise differences), so that the four tails (rlower()
+ *       is kept) lose less than eps/2.  They are taken within the full
+ *       limits kept in the plan on each call, so that a later call
+ *       with a smaller eps widens them again.  The integral over these
+ *       limits is taken by the Gauss-Legendre rule of 16 nodes for
+ *       eps >= 1e-4, 24 for eps >= 1e-6, 32 for eps >= 1e-8 and 40 for
+ *       eps >= EPSG, the fewest that kept the error below eps/2 for
+ *       k=2 to 1000, df=1 to 1e4, nrng=1 to 100 and p=0.001 to
+ *       0.99999.  Below EPSG (and for fractional df < DFFRAC) adapt()
+ *       is used from NUPE intervals until the error estimate is below
+ *       eps/2.  The large-df expansion is used if its error estimate is
+ *       below eps/2.  Normal probabilities are of accuracy 10^(-acc)
+ *       with acc=log10(10 k nrng/eps) (6 <= acc <= 16).  The r-grid
+ *       (mode & 2) is not used.  For k=2, where rng_lp() is one normal
+ *       probability, smrng_lpe() is smrng_lp() for eps >= EPSG.  At the
+ *       quantiles p=0.5 to 0.99 for k=3 to 1000, df=1 to 40 and nrng=1
+ *       and 10, smrng_lpe() takes 0.2 to 0.45 (0.28 in total) of the
+ *       time of smrng_lp() for eps=1e-4, 0.4 to 0.8 (0.50) for
+ *       eps=1e-6 and 0.45 to 0.9 (0.68) for eps=1e-8, and about 8
+ *       times for eps=1e-10.
+ *   13) Only the power nrng of rng_lp(s*q) depends on nrng, so
+ *       smrng_lpn() takes log rng_lp() at the 40 nodes of each of
+ *       npnl panels on (sl, su) cut by rlower() of the smallest and
+ *       rupper() of the largest nrng, and sums exp(nrng*log F) for
+ *       each nrng.  The wider limits need more nodes for steep F^nrng,
+ *       and npnl=1+log10(nmax/nmin) (at most NPNLN) keeps the error
+ *       of order e-10 for nrng=1, ..., 100 (k <= 1000).  It takes
+ *       about 1/25 of the time of 100 calls of smrng_lp().  The
+ *       large-df expansion is not used, and fractional df < DFFRAC
+ *       calls smrng_lp() for each nrng.  nrng[i] < 1 is left out of
+ *       the smallest and the largest nrng, whose log10 ratio would be
+ *       infinite, and p[i] = -1.0 marks it.
+ *   14) The r-grid (Note 7) depends on (k, nrng, acc) and not on df,
+ *       so smrng_plan_df() replaces only the values of df (limits of
+ *       s, coef(df), chi densities and Gauss rules of the large-df
+ *       expansion) and keeps the range probabilities of the panels
+ *       already computed.  A plan of mode & 2 then takes a column of
+ *       df values with only the chi densities computed again for
+ *       each df; smrng_lpf() does so with mode=6.  smrng_plan_eps()
+ *       must be called again after smrng_plan_df().  smrng_lpf()
+ *       agrees with smrng_lp() to about 1e-10 and takes about 1/2
+ *       of the time for the 46 df values of smrng_tbl.  Quantiles
+ *       gain more, since the search calls the plan several times
+ *       for each df.
  *
  *  Stored in
  *   smrng_lp.c
@@ -41,6 +269,23 @@
  *    c. 1994:    First written in Fortran for Studentised range.
  *    2018-11-02: Created for the new version.
  *    2021-05-10: Consider maximum of several ranges.
+ *    2026-10-16: Accuracy of normal probabilities is selectable.
+ *                Range probabilities at all nodes by rng_lpv().
+ *                smrng_lpc() with interpolated range probabilities.
+ *                Plans for fixed (k, df, nrng).
+ *                q-invariant r-grid mode of plans.
+ *                Closed-form chi tail above ru/q by chi2_p().
+ *                Real-valued df and coef(df) by stirlerr().
+ *                Adaptive quadrature for fractional df < 5.
+ *                Large-df expansion in the central moments of s.
+ *                smrng_up() for upper probability.
+ *                smrng_lpd() and smrng_pdf() with the density.
+ *                Tolerance of adapt() follows acc.
+ *                smrng_lpe() and smrng_plan_eps() for absolute error.
+ *                smrng_lpn() for a list of nrng values.
+ *                smrng_plan_df() and smrng_lpf() for a list of df values.
+ *                smrng_plan_init() for plans on the stack.
+ *                Deviance form of chi() for large df.
  *
  *  License
  *    GPLv3 (Free and No Warranty)
@@ -51,9 +296,31 @@
 
 
 #include <math.h>
-#define LOGSQRTPI 0.572364942924700087071713675676529356  // log(sqrt(pi))
+#include <stdlib.h>
+#include "smrng_plan.h"
+#define PI2       6.28318530717958647692528676655900577   // 2*pi
+#define DFASY     100.0    // smallest df of large-df expansion
+#define ASYEPS    1.0e-12  // accuracy required of large-df expansion
+#define ASYDF     400.0    // df/(k*nrng)^0.6 of large-df expansion at ASYEPS
+#define DFFRAC    5.0      // fractional df below this uses adapt()
+#define NUP0      8        // initial number of intervals in adapt()
+#define NINTU     100      // maximum number of intervals in adapt()
+#define UREL      1.0e-10  // relative error required of adapt()
+#define NUPE      2        // initial number of intervals with eps
+#define EPSG      1.0e-9   // smallest eps of the fixed Gauss rules
+#define NPNLN     8        // maximum number of panels in smrng_lpn()
 
-extern double rng_lp(double r, int k);
+extern double rng_lpt(double r, int k, int acc);
+extern void rng_lpv(const double *r, int n, int k, int acc, double *p);
+extern double rng_lpd(double r, int k, int acc, double *d);
+extern void rng_lpdv(const double *r, int n, int k, int acc, double *p,
+                     double *d);
+extern double rng_lpc(double r, int k);
+extern double rng_upt(double r, int k, int acc);
+extern double chi2_p(double x, double df, int upper);
+extern double chi2_q(double t, double df, int upper);
+extern double nrml_q(double p, int upper);
+extern double stirlerr(double a);
 
 /* Upper limit of max range with approx upper prob=0.5e-13.
  */
@@ -104,13 +371,14 @@ static double rlower(int k, int nrng)
 
 /* Upper limit for chi^2(df) with approx upper prob=0.5e-13.
  */
-static double chi2u(int df)
+static double chi2u(double df)
 {
   double  first[5]={56.73, 61.26, 65.01, 68.38, 71.50};
   double  w, z, ddf=2.0/9.0/df;
 
-  if(df <= 5)
-    return(first[df-1]);
+  // Fractional df: the limit of the next integer is larger.
+  if(df <= 5.0)
+    return(first[(int)ceil(df)-1]);
   if(df <= 20)
     w = 7.391 - 3.050/df + 5.208/(df*df);
   else
@@ -122,14 +390,18 @@ static double chi2u(int df)
 
 /* Lower limit for chi^2(df) with approx lower prob=0.5e-13.
  */
-static double chi2l(int df)
+static double chi2l(double df)
 {
   double  first[5]={3.926e-27, 1.0e-13, 3.281e-09, 6.324e-07, 1.546e-05};
   double  w, z, ddf=2.0/9.0/df;
 
-  if(df <= 5)
-    return(first[df-1]);
-  if(df <= 20) {
+  if(df <= 5.0) {
+    if(df == floor(df))
+      return(first[(int)df-1]);
+    // Pr{chi^2 < z} ~ (z/2)^(df/2)/Gamma(df/2+1) for small z.
+    return(2.0*pow(0.5e-13*tgamma(0.5*df + 1.0), 2.0/df));
+  }
+  if(df <= 20.0) {
     // Log approximation.
     w = -8.645 - 70.72/df + 77.47/(df*df);
     z = df*exp(w/sqrt(0.5*df)-1.0/df);
@@ -143,130 +415,1123 @@ static double chi2l(int df)
 }
 
 /* Coefficient of chi distribution (Note: not chi^2 distribution).
+ *   2*a^a*exp(-a)/Gamma(a) = 2*sqrt(a/(2*pi))*exp(-stirlerr(a)), a=df/2
  */
-static double coef(int df)
+static double coef(double df)
 {
-  int n;
-  double g = (df%2 == 1) ? LOGSQRTPI : 0.0;
+  double a = 0.5*df;
 
-  for(n=df-2; n > 0; n -= 2)
-    g += log(0.5*n);
-  return (2.0 * exp(0.5*df*(log(0.5*df)-1.0) - g));
+  return (2.0 * sqrt(a/PI2) * exp(-stirlerr(a)));
 }
 
 /* Integrand function
  */
-static double f(double s, int k, int df, int nrng, double q, int isw)
+static double f(double y, int nrng, double rp)
 {
-  double y=exp((df - 1.0)*log(s) + 0.5*df*(1.0 - s*s));
-  if(isw == 0)
-    return (y);
-  else
-    return (y*pow(rng_lp(s*q, k), (double)nrng));
-}
-
-
-double smrng_lp(double q, int k, int df, int nrng)
-{
-  // 40 nodes and weights for Gauss-Legendre quadrature.
-  const double nd[20]={
-    0.998237709710559200349622702420586492,
-    0.990726238699457006453054352221372155,
-    0.977259949983774262663370283712903807,
-    0.957916819213791655804540999452759285,
-    0.932812808278676533360852166845205716,
-    0.902098806968874296728253330868493104,
-    0.865959503212259503820781808354619964,
-    0.824612230833311663196320230666098774,
-    0.778305651426519387694971545506494848,
-    0.727318255189927103280996451754930549,
-    0.671956684614179548379354514961494110,
-    0.612553889667980237952612450230694877,
-    0.549467125095128202075931305529517970,
-    0.483075801686178712908566574244823005,
-    0.413779204371605001524879745803713683,
-    0.341994090825758473007492481179194310,
-    0.268152185007253681141184344808596183,
-    0.192697580701371099715516852065149895,
-    0.116084070675255208483451284408024114,
-    0.0387724175060508219331934440246232947
+  return (y*pow(rp, (double)nrng));
+}
+
+/* Integrand function of the density
+ *   y s F'(r),  F'(r)=nrng rng_lp(r)^(nrng-1) g(r)
+ * with the range density g(r) in dr.
+ */
+static double fd(double y, double s, int nrng, double rp, double dr)
+{
+  return(y*s*nrng*pow(rp, nrng - 1.0)*dr);
+}
+
+/* Chi density without coefficient,
+ *   s^(df-1) exp(df (1-s^2)/2) = exp(-bd0(df/2, df s^2/2))/s
+ * with the deviance bd0(a, x) = a log(a/x) + x - a of chi2_p.c summed
+ * in v=(1-s^2)/(1+s^2) near s=1 (Note 10).
+ */
+static double chi(double s, double df)
+{
+  double  w=(1.0 - s)*(1.0 + s), v, d, d1, ej;
+  int     j;
+
+  if(fabs(w) >= 0.1*(1.0 + s*s))
+    return(exp((df - 1.0)*log(s) + 0.5*df*w));
+  v = w/(1.0 + s*s);
+  d = 0.5*df*w*v;
+  ej = df*v;
+  v *= v;
+  for(j=1; j < 40; j++) {
+    ej *= v;
+    d1 = d + ej/(2*j + 1);
+    if(d1 == d)
+      break;
+    d = d1;
+  }
+  return(exp(-d)/s);
+}
+
+/* 40 nodes and weights for Gauss-Legendre quadrature.
+ */
+static const double nd[20]={
+  0.998237709710559200349622702420586492,
+  0.990726238699457006453054352221372155,
+  0.977259949983774262663370283712903807,
+  0.957916819213791655804540999452759285,
+  0.932812808278676533360852166845205716,
+  0.902098806968874296728253330868493104,
+  0.865959503212259503820781808354619964,
+  0.824612230833311663196320230666098774,
+  0.778305651426519387694971545506494848,
+  0.727318255189927103280996451754930549,
+  0.671956684614179548379354514961494110,
+  0.612553889667980237952612450230694877,
+  0.549467125095128202075931305529517970,
+  0.483075801686178712908566574244823005,
+  0.413779204371605001524879745803713683,
+  0.341994090825758473007492481179194310,
+  0.268152185007253681141184344808596183,
+  0.192697580701371099715516852065149895,
+  0.116084070675255208483451284408024114,
+  0.0387724175060508219331934440246232947
+};
+static const double wt[20]={
+  0.00452127709853319125847173287818533273,
+  0.0104982845311528136147421710672796524,
+  0.0164210583819078887128634848823639273,
+  0.0222458491941669572615043241842085732,
+  0.0279370069800234010984891575077210773,
+  0.0334601952825478473926781830864108490,
+  0.0387821679744720176399720312904461623,
+  0.0438709081856732719916746860417154958,
+  0.0486958076350722320614341604481463881,
+  0.0532278469839368243549964797722605046,
+  0.0574397690993915513666177309104259856,
+  0.0613062424929289391665379964083985959,
+  0.0648040134566010380745545295667527300,
+  0.0679120458152339038256901082319239860,
+  0.0706116473912867796954836308552868324,
+  0.0728865823958040590605106834425178359,
+  0.0747231690579682642001893362613246732,
+  0.0761103619006262423715580759224948230,
+  0.0770398181642479655883075342838102485,
+  0.0775059479784248112637239629583263270
+};
+
+/* 16, 24 and 32 nodes and weights for the rules of smrng_plan_eps().
+ */
+static const double nd16[8]={
+  0.989400934991649932596154173450332627,
+  0.944575023073232576077988415534608345,
+  0.865631202387831743880467897712393132,
+  0.755404408355003033895101194847442268,
+  0.617876244402643748446671764048791019,
+  0.458016777657227386342419442983577574,
+  0.281603550779258913230460501460496106,
+  0.0950125098376374401853193354249580631
+};
+static const double wt16[8]={
+  0.0271524594117540948517805724560181035,
+  0.0622535239386478928628438369943776943,
+  0.0951585116824927848099251076022462264,
+  0.124628971255533872052476282192016420,
+  0.149595988816576732081501730547478549,
+  0.169156519395002538189312079030359962,
+  0.182603415044923588866763667969219939,
+  0.189450610455068496285396723208283105
+};
+static const double nd24[12]={
+  0.995187219997021360179997409700736812,
+  0.974728555971309498198391993008169062,
+  0.938274552002732758523649001708721450,
+  0.886415527004401034213154341982196755,
+  0.820001985973902921953949872669745208,
+  0.740124191578554364243828103099978426,
+  0.648093651936975569252495786910747627,
+  0.545421471388839535658375617218372370,
+  0.433793507626045138487084231913349712,
+  0.315042679696163374386793291319810241,
+  0.191118867473616309158639820757069632,
+  0.0640568928626056260850430826247450386
+};
+static const double wt24[12]={
+  0.0123412297999871995468056670700372916,
+  0.0285313886289336631813078159518782864,
+  0.0442774388174198061686027482113382289,
+  0.0592985849154367807463677585001085845,
+  0.0733464814110803057340336152531165181,
+  0.0861901615319532759171852029837426672,
+  0.0976186521041138882698806644642471544,
+  0.107444270115965634782577342446606223,
+  0.115505668053725601353344483906783560,
+  0.121670472927803391204463153476262426,
+  0.125837456346828296121375382511183689,
+  0.127938195346752156974056165224695372
+};
+static const double nd32[16]={
+  0.997263861849481563544981128665040727,
+  0.985611511545268335400175044630901979,
+  0.964762255587506430773811928118274960,
+  0.934906075937739689170919134835409326,
+  0.896321155766052123965307243719212268,
+  0.849367613732569970133693004967742539,
+  0.794483795967942406963097298970428902,
+  0.732182118740289680387426665091267147,
+  0.663044266930215200975115168663238369,
+  0.587715757240762329040745476401826858,
+  0.506899908932229390023747474377821230,
+  0.421351276130635345364119436172426478,
+  0.331868602282127649779916805730187996,
+  0.239287362252137074544603209165501521,
+  0.144471961582796493485186373598810652,
+  0.0483076656877383162348125704405021637
+};
+static const double wt32[16]={
+  0.00701861000947009660040706373885318251,
+  0.0162743947309056706051705622063866182,
+  0.0253920653092620594557525897892240293,
+  0.0342738629130214331026877322523727070,
+  0.0428358980222266806568786466061255285,
+  0.0509980592623761761961632446895216953,
+  0.0586840934785355471452836373001708868,
+  0.0658222227763618468376500637069387729,
+  0.0723457941088485062253993564784877916,
+  0.0781938957870703064717409188283066710,
+  0.0833119242269467552221990746043486115,
+  0.0876520930044038111427714627518022875,
+  0.0911738786957638847128685771116370625,
+  0.0938443990808045656391802376681172600,
+  0.0956387200792748594190820022041311006,
+  0.0965400885147278005667648300635757947
+};
+
+/* Gauss rules with n=4, 5 and 6 points for the distribution of
+ * z=(chi^2/df-1)/sqrt(2/df), whose cumulants are
+ *   kz[1]=0, kz[2]=1, kz[j]=(j-1)! 2^(j/2-1) df^(1-j/2).
+ * The recurrence coefficients of the orthogonal polynomials are
+ * taken from the moments by the Chebyshev algorithm, and the nodes
+ * by Newton's method with deflation from those of Hermite
+ * polynomials.  The nodes
+ * and weights are stored in z[] and w[] (4 for n=4, then 5 for n=5
+ * and 6 for n=6).
+ */
+static void gauss(double df, double *z, double *w)
+{
+  double  he[15]={-2.33441421833897723, -0.741963784302725858,
+                  0.741963784302725858, 2.33441421833897723,
+                  -2.85697001387280565, -1.35562617997426587, 0.0,
+                  1.35562617997426587, 2.85697001387280565,
+                  -3.32425743355211895, -1.88917587775371068,
+                  -0.616706590192594152, 0.616706590192594152,
+                  1.88917587775371068, 3.32425743355211895};
+  double  kz[12], m[12], s0[12], s1[12], s2[12], al[6], be[6];
+  double  c, x, dx, p0, p1, p2, d0, d1, d2, nrm, sum;
+  int     n, i, j, l, itr;
+
+  // Moments of z from its cumulants.
+  kz[1] = 0.0;
+  kz[2] = 1.0;
+  for(j=3; j < 12; j++)
+    kz[j] = kz[j-1]*(j - 1)*sqrt(2.0/df);
+  m[0] = 1.0;
+  for(j=1; j < 12; j++) {
+    m[j] = 0.0;
+    c = 1.0;    // binomial(j-1, i-1)
+    for(i=1; i <= j; i++) {
+      m[j] += c*kz[i]*m[j-i];
+      c = c*(j - i)/i;
+    }
+  }
+
+  // Chebyshev algorithm for alpha[0..5] and beta[0..5].
+  for(l=0; l < 12; l++) {
+    s0[l] = 0.0;
+    s1[l] = m[l];
+  }
+  al[0] = m[1]/m[0];
+  be[0] = m[0];
+  for(j=1; j < 6; j++) {
+    for(l=j; l < 12-j; l++)
+      s2[l] = s1[l+1] - al[j-1]*s1[l] - be[j-1]*s0[l];
+    al[j] = s2[j+1]/s2[j] - s1[j]/s1[j-1];
+    be[j] = s2[j]/s1[j-1];
+    for(l=0; l < 12; l++) {
+      s0[l] = s1[l];
+      s1[l] = s2[l];
+    }
+  }
+
+  for(i=0; i < 15; i++) {
+    n = (i < 4) ? 4 : (i < 9) ? 5 : 6;
+    x = he[i];
+    for(itr=0; itr < 50; itr++) {
+      p0 = 0.0;
+      p1 = 1.0;
+      d0 = 0.0;
+      d1 = 0.0;
+      for(j=0; j < n; j++) {
+        p2 = (x - al[j])*p1 - be[j]*p0;
+        d2 = p1 + (x - al[j])*d1 - be[j]*d0;
+        p0 = p1;
+        p1 = p2;
+        d0 = d1;
+        d1 = d2;
+      }
+      // Deflation by the nodes already found.
+      sum = 0.0;
+      for(l=(n == 4) ? 0 : (n == 5) ? 4 : 9; l < i; l++)
+        sum += 1.0/(x - z[l]);
+      dx = p1/(d1 - p1*sum);
+      x -= dx;
+      if(fabs(dx) < 1.0e-15*(1.0 + fabs(x)))
+        break;
+    }
+    z[i] = x;
+    // Christoffel number
+    p0 = 0.0;
+    p1 = 1.0;
+    nrm = be[0];
+    sum = 1.0/nrm;
+    for(j=0; j < n-1; j++) {
+      p2 = (x - al[j])*p1 - be[j]*p0;
+      p0 = p1;
+      p1 = p2;
+      nrm *= be[j+1];
+      sum += p1*p1/nrm;
+    }
+    w[i] = 1.0/sum;
+  }
+}
+
+/* Error n!/(2n)! f^(2n) of the 6-point rule for f(z)=exp(L*z)
+ */
+static double gerr(double l)
+{
+  return(720.0/479001600.0*pow(l, 12.0)*exp(0.5*l*l));
+}
+
+/* Large-df expansion (mode & 4)
+ *   E[F(q*s)] = E[F(q*sqrt(1+sqrt(2/df)*z))],  F(r)=rng_lp(r, k)^nrng
+ * by the 6-point Gauss rule of gauss(), and E[s F'(q*s)] in *pdf
+ * unless pdf == NULL.  *err is the difference from
+ * the 5-point rule (plus 1% of that between the 5- and 4-point rules
+ * against accidental agreement), the mass of s beyond the nodes where
+ * F=0 or 1 by rl or ru, and the error of the 6-point rule if F (or
+ * 1-F) were exponential beyond the outermost nodes.
+ */
+static double asym(const struct smrng_plan *pl, double q, double *err,
+                   double *pdf)
+{
+  const double *z=pl->gz, *w=pl->gw;
+  double  sd=sqrt(2.0/pl->df), r[15], y[15], dr[15], s, p4=0.0, p5=0.0,
+          p6=0.0, l;
+  int     i;
+
+  for(i=0; i < 15; i++)
+    r[i] = q*sqrt(1.0 + sd*z[i]);
+  if(pdf != NULL)
+    rng_lpdv(r, 15, pl->k, pl->acc, y, dr);
+  if(pl->mode & 1) {
+    for(i=0; i < 15; i++)
+      y[i] = rng_lpc(r[i], pl->k);
+  }
+  else if(pdf == NULL)
+    rng_lpv(r, 15, pl->k, pl->acc, y);
+  // F=0 below rl and F=1 above ru as in the outer integration.
+  for(i=0; i < 15; i++) {
+    if(r[i] <= pl->rl || r[i] >= pl->ru) {
+      y[i] = (r[i] <= pl->rl) ? 0.0 : 1.0;
+      if(pdf != NULL)
+        dr[i] = 0.0;
+    }
+    else {
+      // E[s F'(q*s)] is the derivative in q.
+      if(pdf != NULL) {
+        s = r[i]/q;
+        dr[i] = fd(1.0, s, pl->nrng, y[i], dr[i]);
+      }
+      y[i] = pow(y[i], (double)pl->nrng);
+    }
+  }
+
+  for(i=0; i < 4; i++)
+    p4 += w[i]*y[i];
+  for(i=4; i < 9; i++)
+    p5 += w[i]*y[i];
+  for(i=9; i < 15; i++)
+    p6 += w[i]*y[i];
+  *err = fabs(p6 - p5) + 0.01*fabs(p5 - p4);
+  if(pdf != NULL) {
+    p4 = p5 = *pdf = 0.0;
+    for(i=0; i < 4; i++)
+      p4 += w[i]*dr[i];
+    for(i=4; i < 9; i++)
+      p5 += w[i]*dr[i];
+    for(i=9; i < 15; i++)
+      *pdf += w[i]*dr[i];
+    *err += fabs(*pdf - p5) + 0.01*fabs(p5 - p4);
+  }
+
+  // Mass of s beyond the nodes if F=0 (1-F=0) there by rl (ru).
+  if(y[14] == 0.0)
+    *err += chi2_p(pl->df*(pl->rl/q)*(pl->rl/q), pl->df, 1);
+  if(y[9] == 1.0)
+    *err += chi2_p(pl->df*(pl->ru/q)*(pl->ru/q), pl->df, 0);
+
+  // Steep F at the upper end and steep 1-F at the lower end.
+  // (The density has the same tails.)
+  if(y[14] > 0.0) {
+    if(y[13] <= 0.0)
+      *err = 1.0;
+    else {
+      l = log(y[14]/y[13])/(z[14] - z[13]);
+      *err += y[14]*exp(-l*z[14])*gerr(l);
+    }
+  }
+  if(y[9] < 1.0) {
+    if(y[10] >= 1.0)
+      *err = 1.0;
+    else {
+      l = log((1.0 - y[9])/(1.0 - y[10]))/(z[10] - z[9]);
+      *err += (1.0 - y[9])*exp(l*z[9])*gerr(l);
+    }
+  }
+  return(p6);
+}
+
+/* Half nodes *x and weights *w of the rule of the plan (ne nodes, or
+ * 40 if ne == 0).  Returns the number of pairs of nodes.
+ */
+static int rule(const struct smrng_plan *pl, const double **x,
+                const double **w)
+{
+  switch(pl->ne) {
+  case 16:
+    *x = nd16;
+    *w = wt16;
+    return(8);
+  case 24:
+    *x = nd24;
+    *w = wt24;
+    return(12);
+  case 32:
+    *x = nd32;
+    *w = wt32;
+    return(16);
+  }
+  *x = nd;
+  *w = wt;
+  return(20);
+}
+
+/* Whether the large-df expansion is tried (mode & 4), and its
+ * tolerance in *tol.  Below df = ASYDF (k*nrng)^0.6 (tol/ASYEPS)^(-1/6)
+ * it is rejected at most quantile points (Note 9).
+ */
+static int asyok(const struct smrng_plan *pl, double *tol)
+{
+  *tol = (pl->eps > 0.0) ? 0.5*pl->eps : fmax(pow(0.1, pl->acc), ASYEPS);
+  return((pl->mode & 4) && pl->df >= DFASY
+         && pl->df >= ASYDF*pow((double)pl->k*pl->nrng, 0.6)
+                      *pow(*tol/ASYEPS, -1.0/6.0));
+}
+
+/* Values that depend on df.
+ */
+static void plan_df(struct smrng_plan *pl, double df)
+{
+  pl->df = df;
+  pl->ng = 0;
+  if(df <= 0)
+    return;
+
+  pl->sl = pl->sl0 = sqrt(chi2l(df)/df);
+  pl->su = pl->su0 = sqrt(chi2u(df)/df);
+  pl->cnst = coef(df);
+  if(df >= DFASY)
+    gauss(df, pl->gz, pl->gw);
+}
+
+static void plan_init(struct smrng_plan *pl, int k, double df, int nrng,
+                      int acc, int mode)
+{
+  int     i;
+
+  pl->k = k;
+  pl->nrng = nrng;
+  pl->acc = acc;
+  pl->mode = mode;
+  pl->eps = 0.0;
+  pl->ne = 0;
+  for(i=0; i < NPNL; i++)
+    pl->nr[i] = 0;
+  pl->rl = rlower(k, nrng);
+  pl->ru = pl->ru0 = rupper(k, nrng);
+  plan_df(pl, df);
+}
+
+/* Chi densities at the nodes on (sl, su).
+ */
+static void plan_g(struct smrng_plan *pl)
+{
+  const double *xn, *wn;
+  double  cntr, wdth, x;
+  int     i, n=rule(pl, &xn, &wn);
+
+  if(pl->df <= 0)
+    return;
+  cntr = 0.5*(pl->sl + pl->su);
+  wdth = 0.5*(pl->su - pl->sl);
+  for(i=0; i < n; i++) {
+    x = wdth*xn[i];
+    pl->g[2*i] = chi(cntr-x, pl->df);
+    pl->g[2*i+1] = chi(cntr+x, pl->df);
+  }
+  pl->ng = 1;
+}
+
+void smrng_plan_init(struct smrng_plan *pl, int k, double df, int nrng,
+                     int acc, int mode)
+{
+  plan_init(pl, k, df, nrng, acc, mode);
+}
+
+struct smrng_plan *smrng_plan_new(int k, double df, int nrng, int acc,
+                                  int mode)
+{
+  struct smrng_plan *pl;
+
+  pl = (struct smrng_plan *)malloc(sizeof(struct smrng_plan));
+  if(pl == NULL)
+    return(NULL);
+  plan_init(pl, k, df, nrng, acc, mode);
+  plan_g(pl);
+  return(pl);
+}
+
+void smrng_plan_df(struct smrng_plan *pl, double df)
+{
+  plan_df(pl, df);
+  plan_g(pl);
+}
+
+void smrng_plan_free(struct smrng_plan *pl)
+{
+  free(pl);
+}
+
+void smrng_plan_par(const struct smrng_plan *pl, int *k, double *df,
+                    int *nrng)
+{
+  *k = pl->k;
+  *df = pl->df;
+  *nrng = pl->nrng;
+}
+
+void smrng_plan_eps(struct smrng_plan *pl, double eps)
+{
+  double  t=0.125*eps;
+  int     i;
+
+  pl->eps = eps;
+  pl->acc = (int)ceil(log10(10.0*pl->k*(double)pl->nrng/eps));
+  if(pl->acc < 6)
+    pl->acc = 6;
+  if(pl->acc > 16)
+    pl->acc = 16;
+  pl->ng = 0;
+  for(i=0; i < NPNL; i++)
+    pl->nr[i] = 0;
+  // Pr{R > r} <= k(k-1) Q(r/sqrt(2)) for each range.
+  pl->ru = fmin(pl->ru0,
+                sqrt(2.0)*nrml_q(t/(pl->nrng*pl->k*(pl->k - 1.0)), 1));
+  if(pl->df <= 0)
+    return;
+  pl->sl = fmax(pl->sl0, sqrt(chi2_q(t, pl->df, 0)/pl->df));
+  pl->su = fmin(pl->su0, sqrt(chi2_q(t, pl->df, 1)/pl->df));
+  // Rule on the limits above (Note 12).
+  pl->ne = (eps >= 1.0e-4) ? 16 : (eps >= 1.0e-6) ? 24
+    : (eps >= 1.0e-8) ? 32 : 0;
+  plan_g(pl);
+}
+
+/* \int_{sl}^{ru/q} chi(s) rng_lp(s*q)^nrng ds
+ *   = 1/q \int_{rl}^{ru} chi(r/q) rng_lp(r)^nrng dr
+ * on the r-grid of NPNL panels (mode & 2), and the same with
+ * (r/q) F'(r) in *pd unless pd == NULL.
+ * Returns 0 if the chi density is too narrow for the grid.
+ */
+static int grid(struct smrng_plan *pl, double q, double *p, double *pd)
+{
+  double  h=(pl->ru - pl->rl)/(NPNL), r0, cntr, wdth, x, p1, d1, r[40], y[40];
+  int     i, j, nr=(pd == NULL) ? 1 : 3;
+
+  if(q*(pl->su - pl->sl) < 4.0*h)
+    return(0);
+
+  *p = 0.0;
+  if(pd != NULL)
+    *pd = 0.0;
+  for(j=0; j < NPNL; j++) {
+    r0 = pl->rl + j*h;
+    if(r0 + h <= q*pl->sl || r0 >= q*pl->su)
+      continue;
+    cntr = r0 + 0.5*h;
+    wdth = 0.5*h;
+
+    // Range probabilities of the panel are computed only once.
+    if((pl->nr[j] & nr) != nr) {
+      for(i=0; i < 20; i++) {
+        x = wdth*nd[i];
+        r[2*i] = cntr-x;
+        r[2*i+1] = cntr+x;
+      }
+      if(pd != NULL)
+        rng_lpdv(r, 40, pl->k, pl->acc, y, pl->rd[j]);
+      if(pl->mode & 1) {
+        for(i=0; i < 40; i++)
+          y[i] = rng_lpc(r[i], pl->k);
+      }
+      else if(pd == NULL)
+        rng_lpv(r, 40, pl->k, pl->acc, y);
+      for(i=0; i < 40; i++) {
+        if(pd != NULL)
+          pl->rd[j][i] = fd(1.0, 1.0, pl->nrng, y[i], pl->rd[j][i]);
+        pl->rg[j][i] = pow(y[i], (double)pl->nrng);
+      }
+      pl->nr[j] |= nr;
+    }
+
+    p1 = 0.0;
+    for(i=0; i < 20; i++) {
+      x = wdth*nd[i];
+      p1 += wt[i] * (chi((cntr-x)/q, pl->df)*pl->rg[j][2*i]
+                     + chi((cntr+x)/q, pl->df)*pl->rg[j][2*i+1]);
+    }
+    *p += wdth*p1;
+    if(pd != NULL) {
+      d1 = 0.0;
+      for(i=0; i < 20; i++) {
+        x = wdth*nd[i];
+        d1 += wt[i] * (chi((cntr-x)/q, pl->df)*(cntr-x)*pl->rd[j][2*i]
+                       + chi((cntr+x)/q, pl->df)*(cntr+x)*pl->rd[j][2*i+1]);
+      }
+      *pd += wdth*d1;
+    }
+  }
+  *p /= q;
+  if(pd != NULL)
+    *pd /= q*q;
+  return(1);
+}
+
+/* Integrand of adapt()
+ *   chi(s) rng_lp(s*q)^nrng (upper == 0)
+ *   chi(s) [1 - rng_lp(s*q)^nrng] (upper != 0)
+ * and chi(s) s F'(s*q) of the density in *dv unless dv == NULL.
+ */
+static double fu(const struct smrng_plan *pl, double s, double q, int upper,
+                 double *dv)
+{
+  double  u, dr;
+
+  if(upper) {
+    u = rng_upt(s*q, pl->k, pl->acc);
+    if(dv != NULL) {
+      rng_lpd(s*q, pl->k, pl->acc, &dr);
+      *dv = fd(chi(s, pl->df), s, pl->nrng, 1.0 - u, dr);
+    }
+    return(chi(s, pl->df) * (-expm1(pl->nrng*log1p(-u))));
+  }
+  if(dv != NULL) {
+    u = rng_lpd(s*q, pl->k, pl->acc, &dr);
+    if(pl->mode & 1)
+      u = rng_lpc(s*q, pl->k);
+    *dv = fd(chi(s, pl->df), s, pl->nrng, u, dr);
+    return(f(chi(s, pl->df), pl->nrng, u));
+  }
+  u = (pl->mode & 1) ? rng_lpc(s*q, pl->k) : rng_lpt(s*q, pl->k, pl->acc);
+  return(f(chi(s, pl->df), pl->nrng, u));
+}
+
+/* 15-point Kronrod rule on (a, b) with the error estimate
+ * from the embedded 7-point Gauss rule, and that of the density
+ * in *pd unless pd == NULL.
+ */
+static double gk15(const struct smrng_plan *pl, double q, int upper,
+                   double a, double b, double *err, double *pd)
+{
+  const double xgk[8]={
+    0.991455371120812639206854697526329,
+    0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926,
+    0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013,
+    0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245,
+    0.0
   };
-  const double wt[20]={
-    0.00452127709853319125847173287818533273,
-    0.0104982845311528136147421710672796524,
-    0.0164210583819078887128634848823639273,
-    0.0222458491941669572615043241842085732,
-    0.0279370069800234010984891575077210773,
-    0.0334601952825478473926781830864108490,
-    0.0387821679744720176399720312904461623,
-    0.0438709081856732719916746860417154958,
-    0.0486958076350722320614341604481463881,
-    0.0532278469839368243549964797722605046,
-    0.0574397690993915513666177309104259856,
-    0.0613062424929289391665379964083985959,
-    0.0648040134566010380745545295667527300,
-    0.0679120458152339038256901082319239860,
-    0.0706116473912867796954836308552868324,
-    0.0728865823958040590605106834425178359,
-    0.0747231690579682642001893362613246732,
-    0.0761103619006262423715580759224948230,
-    0.0770398181642479655883075342838102485,
-    0.0775059479784248112637239629583263270
+  const double wgk[8]={
+    0.022935322010529224963732008058970,
+    0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518,
+    0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550,
+    0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649,
+    0.209482141084727828012999174891714
   };
-  double  sl, su, cnst, rlq, ruq, sll, x;
-  double  p=0.0, p1, cntr, wdth;
-  int     isw=0, i;
+  const double wg[4]={
+    0.129484966168869693270611432679082,
+    0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975,
+    0.417959183673469387755102040816327
+  };
+  double  cntr=0.5*(a + b), wdth=0.5*(b - a), fc, f2, rk, rg, d1, d2;
+  double  *dv1=(pd == NULL) ? NULL : &d1, *dv2=(pd == NULL) ? NULL : &d2;
+  int     i;
+
+  fc = fu(pl, cntr, q, upper, dv1);
+  rk = wgk[7]*fc;
+  rg = wg[3]*fc;
+  if(pd != NULL)
+    *pd = wgk[7]*d1;
+  for(i=0; i < 7; i++) {
+    f2 = fu(pl, cntr - wdth*xgk[i], q, upper, dv1)
+         + fu(pl, cntr + wdth*xgk[i], q, upper, dv2);
+    rk += wgk[i]*f2;
+    if(i%2 == 1)
+      rg += wg[i/2]*f2;
+    if(pd != NULL)
+      *pd += wgk[i]*(d1 + d2);
+  }
+  *err = fabs((rk - rg)*wdth);
+  if(pd != NULL)
+    *pd *= wdth;
+  return(rk*wdth);
+}
+
+/* \int_{s0}^{s1} fu(s) ds by adaptive Gauss-Kronrod quadrature
+ * from NUP0 geometric intervals until the error estimate is below
+ * max(10^-acc, UREL) times cnst*(the integral) + head, or below eps/2
+ * from NUPE intervals when eps > 0 (or NINTU intervals are used).
+ * The density is integrated on the same intervals into *pd unless
+ * pd == NULL.
+ */
+static double adapt(const struct smrng_plan *pl, double q, int upper,
+                    double s0, double s1, double head, double *pd)
+{
+  double  a[NINTU], b[NINTU], p[NINTU], e[NINTU], d[NINTU];
+  double  *dp=(pd == NULL) ? NULL : d;
+  double  h, c, ptot, etot, emax, tol;
+  int     n, i, imax=0, n0=(pl->eps > 0.0) ? NUPE : NUP0;
+
+  h = pow(s1/s0, 1.0/n0);
+  for(n=0; n < n0; n++) {
+    a[n] = (n == 0) ? s0 : b[n-1];
+    b[n] = (n == n0-1) ? s1 : a[n]*h;
+    p[n] = gk15(pl, q, upper, a[n], b[n], &e[n],
+                (dp == NULL) ? NULL : &dp[n]);
+  }
+
+  for(;;) {
+    ptot = 0.0;
+    etot = 0.0;
+    emax = -1.0;
+    for(i=0; i < n; i++) {
+      ptot += p[i];
+      etot += e[i];
+      if(e[i] > emax) {
+        emax = e[i];
+        imax = i;
+      }
+    }
+    tol = (pl->eps > 0.0) ? 0.5*pl->eps
+      : fmax(pow(0.1, pl->acc), UREL)*(head + pl->cnst*ptot);
+    if(pl->cnst*etot <= tol || n >= NINTU)
+      break;
+
+    // Bisect the interval with the largest error.
+    c = 0.5*(a[imax] + b[imax]);
+    a[n] = c;
+    b[n] = b[imax];
+    b[imax] = c;
+    p[imax] = gk15(pl, q, upper, a[imax], b[imax], &e[imax],
+                   (dp == NULL) ? NULL : &dp[imax]);
+    p[n] = gk15(pl, q, upper, a[n], b[n], &e[n],
+                (dp == NULL) ? NULL : &dp[n]);
+    n++;
+  }
+  if(pd != NULL) {
+    *pd = 0.0;
+    for(i=0; i < n; i++)
+      *pd += d[i];
+  }
+  return(ptot);
+}
+
+/* Limits (*sl, *su) of s cut by those of max range rl/q and ru/q.
+ * Returns 0 or 1 if the lower probability is 0 or 1, and -1 if it is
+ * to be integrated.
+ */
+static int slim(const struct smrng_plan *pl, double q, double *sl,
+                double *su)
+{
+  double  rlq=pl->rl/q, ruq=pl->ru/q;
+
+  *sl = pl->sl;
+  *su = pl->su;
+  if(rlq >= *su)
+    return(0);
+  if(rlq > *sl)
+    *sl = rlq;
+  if(ruq <= *sl)
+    return(1);
+  return(-1);
+}
+
+/* 40 nodes r=s*q on (sl, su), or the ne nodes of the rule of
+ * smrng_plan_eps().  Returns the number of nodes.
+ */
+static int nodes(const struct smrng_plan *pl, double sl, double su,
+                 double q, double *r)
+{
+  const double *xn, *wn;
+  double  cntr=0.5*(sl+su), wdth=0.5*(su-sl), x;
+  int     i, n=rule(pl, &xn, &wn);
+
+  for(i=0; i < n; i++) {
+    x = wdth*xn[i];
+    r[2*i] = (cntr-x)*q;
+    r[2*i+1] = (cntr+x)*q;
+  }
+  return(2*n);
+}
+
+/* \int_{sl}^{su} chi(s) F(s*q) ds by the rule of nodes() with
+ * rp[i]=rng_lp(r[i]) at nodes(), and the density in *pdf with the
+ * range densities dr[i] unless pdf == NULL.
+ */
+static double gsum(const struct smrng_plan *pl, double sl, double su,
+                   const double *rp, const double *dr, double *pdf)
+{
+  const double *xn, *wn;
+  double  cntr=0.5*(sl+su), wdth=0.5*(su-sl), x, p=0.0, pd=0.0, g[40];
+  int     i, nrng=pl->nrng, n=rule(pl, &xn, &wn);
+
+  // Chi densities, which are stored in the plan for (sl, su).
+  if(pl->ng && sl == pl->sl && su == pl->su) {
+    for(i=0; i < 2*n; i++)
+      g[i] = pl->g[i];
+  }
+  else {
+    for(i=0; i < n; i++) {
+      x = wdth*xn[i];
+      g[2*i] = chi(cntr-x, pl->df);
+      g[2*i+1] = chi(cntr+x, pl->df);
+    }
+  }
+
+  for(i=0; i < n; i++)
+    p += wn[i] * (f(g[2*i], nrng, rp[2*i]) + f(g[2*i+1], nrng, rp[2*i+1]));
+  p *= wdth;
+  if(pdf != NULL) {
+    for(i=0; i < n; i++) {
+      x = wdth*xn[i];
+      pd += wn[i] * (fd(g[2*i], cntr-x, nrng, rp[2*i], dr[2*i])
+                     + fd(g[2*i+1], cntr+x, nrng, rp[2*i+1], dr[2*i+1]));
+    }
+    *pdf = pl->cnst*wdth*pd;
+  }
+  return(p);
+}
+
+double smrng_plan_lpd(struct smrng_plan *pl, double q, double *pdf)
+{
+  int     k=pl->k, nrng=pl->nrng, acc=pl->acc;
+  double  df=pl->df;
+  int     cache=pl->mode & 1;
+  double  sl, su, cnst, ruq, x;
+  double  p=0.0, tail=0.0, r[40], rp[40], err, tol;
+  double  pd=0.0, dr[40];
+  int     i, n;
 
+  if(pdf != NULL)
+    *pdf = 0.0;
   if(q <= 0.0)
     return(0.0);
   // df = infinity
-  if(df <= 0)
-    return(pow(rng_lp(q, k), (double)nrng));
+  if(df <= 0) {
+    if(pdf == NULL)
+      return(pow(cache ? rng_lpc(q, k) : rng_lpt(q, k, acc), (double)nrng));
+    p = rng_lpd(q, k, acc, &x);
+    if(cache)
+      p = rng_lpc(q, k);
+    *pdf = fd(1.0, 1.0, nrng, p, x);
+    return(pow(p, (double)nrng));
+  }
 
-  // Upper and lower integral limits
-  sl = sqrt(chi2l(df)/df);
-  su = sqrt(chi2u(df)/df);
-  cnst = coef(df);
+  // Upper and lower integral limits cut by those of max range.
+  if((i = slim(pl, q, &sl, &su)) >= 0)
+    return((double)i);
+  cnst = pl->cnst;
+  ruq = pl->ru/q;
 
-  // Lower limit of max range.
-  rlq = rlower(k, nrng)/q;
-  if(rlq >= su)
-    return(0.0);
-  if(rlq > sl)
-    sl = rlq;
+  // Large-df expansion if it is accurate enough.
+  if(asyok(pl, &tol)) {
+    p = asym(pl, q, &err, pdf);
+    if(err <= tol)
+      return(p);
+    p = 0.0;
+  }
+
+  // If ru/q < su, then rng_lp(s*q)=1.0 on (ru/q, su), and
+  //   \int_{ru/q}^{\infty} = Pr{chi^2(df) > df*(ru/q)^2}.
+  if(ruq < su) {
+    tail = chi2_p(df*ruq*ruq, df, 1);
+    su = ruq;
+  }
+
+  // chi(s) ~ s^(df-1) is not smooth at s=0 for fractional df, and
+  // the fixed rules do not reach eps < EPSG.
+  if((df < DFFRAC && df != floor(df))
+     || (pl->eps > 0.0 && pl->eps < EPSG)) {
+    p = cnst*adapt(pl, q, 0, sl, su, tail, pdf) + tail;
+    if(pdf != NULL)
+      *pdf *= cnst;
+    return(p);
+  }
 
-  // Upper limit of max range.
-  ruq = rupper(k, nrng)/q;
-  if(ruq <= sl)
+  if((pl->mode & 2) && pl->eps == 0.0
+     && grid(pl, q, &p, (pdf == NULL) ? NULL : &pd)) {
+    if(pdf != NULL)
+      *pdf = cnst*pd;
+    return(cnst*p + tail);
+  }
+
+  // Range probabilities at all nodes at once.
+  n = nodes(pl, sl, su, q, r);
+  if(pdf != NULL)
+    rng_lpdv(r, n, k, acc, rp, dr);
+  if(cache) {
+    for(i=0; i < n; i++)
+      rp[i] = rng_lpc(r[i], k);
+  }
+  else if(pdf == NULL)
+    rng_lpv(r, n, k, acc, rp);
+
+  p = gsum(pl, sl, su, rp, dr, pdf);
+  return (cnst*p + tail);
+}
+
+double smrng_plan_lp(struct smrng_plan *pl, double q)
+{
+  return(smrng_plan_lpd(pl, q, NULL));
+}
+
+double smrng_lpt(double q, int k, double df, int nrng, int acc)
+{
+  struct smrng_plan pl;
+
+  plan_init(&pl, k, df, nrng, acc, 4);
+  return(smrng_plan_lp(&pl, q));
+}
+
+double smrng_lpc(double q, int k, double df, int nrng)
+{
+  struct smrng_plan pl;
+
+  plan_init(&pl, k, df, nrng, 16, 5);
+  return(smrng_plan_lp(&pl, q));
+}
+
+double smrng_lp(double q, int k, double df, int nrng)
+{
+  return(smrng_lpt(q, k, df, nrng, 16));
+}
+
+double smrng_lpd(double q, int k, double df, int nrng, double *pdf)
+{
+  struct smrng_plan pl;
+
+  plan_init(&pl, k, df, nrng, 16, 4);
+  return(smrng_plan_lpd(&pl, q, pdf));
+}
+
+double smrng_pdf(double q, int k, double df, int nrng)
+{
+  double  pdf;
+
+  smrng_lpd(q, k, df, nrng, &pdf);
+  return(pdf);
+}
+
+double smrng_plan_upd(struct smrng_plan *pl, double q, double *pdf)
+{
+  double  df=pl->df, rlq, head, u, dr;
+
+  if(pdf != NULL)
+    *pdf = 0.0;
+  if(q <= 0.0)
     return(1.0);
+  // df = infinity
+  if(df <= 0) {
+    u = rng_upt(q, pl->k, pl->acc);
+    if(pdf != NULL) {
+      rng_lpd(q, pl->k, pl->acc, &dr);
+      *pdf = fd(1.0, 1.0, pl->nrng, 1.0 - u, dr);
+    }
+    return(-expm1(pl->nrng*log1p(-u)));
+  }
+
+  // 1 - rng_lp(s*q)^nrng = 1 on (0, rl/q).
+  rlq = pl->rl/q;
+  head = chi2_p(df*rlq*rlq, df, 0);
+  if(rlq >= pl->su)
+    return(head);
 
-  // If ru/q < su, then integrate twice:
-  //   1) \int_{sl}^{ru/q}
-  //   2) \int_{ru/q}^{su}, where rng_p(s*q)=1.0
-  // First integrate the latter (with isw=0).
+  // Geometric intervals, since the mass is near rl/q for small df.
+  u = head + pl->cnst*adapt(pl, q, 1, rlq, pl->su, head, pdf);
+  if(pdf != NULL)
+    *pdf *= pl->cnst;
+  return(u);
+}
+
+double smrng_plan_up(struct smrng_plan *pl, double q)
+{
+  return(smrng_plan_upd(pl, q, NULL));
+}
+
+double smrng_upt(double q, int k, double df, int nrng, int acc)
+{
+  struct smrng_plan pl;
+
+  plan_init(&pl, k, df, nrng, acc, 0);
+  return(smrng_plan_up(&pl, q));
+}
+
+double smrng_up(double q, int k, double df, int nrng)
+{
+  return(smrng_upt(q, k, df, nrng, 16));
+}
+
+double smrng_lpe(double q, int k, double df, int nrng, double eps)
+{
+  struct smrng_plan pl;
+
+  plan_init(&pl, k, df, nrng, 16, 4);
+  // For k=2, rng_lp() is one normal probability, and the limits of
+  // smrng_plan_eps() cost more than the fewer nodes save.
+  if(k > 2 || eps < EPSG)
+    smrng_plan_eps(&pl, eps);
+  return(smrng_plan_lp(&pl, q));
+}
+
+void smrng_lpn(double q, int k, double df, const int *nrng, int nn,
+               double *p)
+{
+  struct smrng_plan pl;
+  double  sl, su, rlq, ruq, tail=0.0, cntr, wdth, x, p1;
+  double  r[40], lr[40], g[40];
+  int     nmin, nmax, npnl, i, j, l;
+
+  // nrng[j] < 1 is skipped with p[j] = -1.0.
+  nmin = nmax = 0;
+  for(j=0; j < nn; j++) {
+    if(nrng[j] < 1) {
+      p[j] = -1.0;
+      continue;
+    }
+    if(nmin == 0 || nrng[j] < nmin)
+      nmin = nrng[j];
+    if(nrng[j] > nmax)
+      nmax = nrng[j];
+  }
+  if(nmax == 0)
+    return;
+  if(q <= 0.0) {
+    for(j=0; j < nn; j++)
+      if(nrng[j] > 0)
+        p[j] = 0.0;
+    return;
+  }
+  // df = infinity
+  if(df <= 0) {
+    x = log(rng_lpt(q, k, 16));
+    for(j=0; j < nn; j++)
+      if(nrng[j] > 0)
+        p[j] = exp(nrng[j]*x);
+    return;
+  }
+  // Fractional df needs adapt() for each nrng.
+  if(df < DFFRAC && df != floor(df)) {
+    for(j=0; j < nn; j++)
+      if(nrng[j] > 0)
+        p[j] = smrng_lp(q, k, df, nrng[j]);
+    return;
+  }
+
+  // Limits of s for the smallest rl and the largest ru.
+  plan_init(&pl, k, df, nmax, 16, 0);
+  sl = pl.sl;
+  su = pl.su;
+  rlq = rlower(k, nmin)/q;
+  ruq = pl.ru/q;
+  for(j=0; j < nn; j++)
+    if(nrng[j] > 0)
+      p[j] = (rlq >= su) ? 0.0 : 1.0;
+  if(rlq >= su || ruq <= sl)
+    return;
+  if(rlq > sl)
+    sl = rlq;
   if(ruq < su) {
-    sll = sl;
-    sl = ruq;
+    tail = chi2_p(df*ruq*ruq, df, 1);
+    su = ruq;
   }
-  else
-    isw = 1;
+  for(j=0; j < nn; j++)
+    if(nrng[j] > 0)
+      p[j] = 0.0;
 
-  for( ; isw < 2; isw++) {
-    p1 = 0.0;
-    cntr = 0.5*(sl+su);
-    wdth = 0.5*(su-sl);
+  // One more panel for each decade of nmax/nmin.
+  npnl = 1 + (int)ceil(log10((double)nmax/nmin) - 1e-9);
+  if(npnl > NPNLN)
+    npnl = NPNLN;
+  wdth = 0.5*(su-sl)/npnl;
+  for(l=0; l < npnl; l++) {
+    cntr = sl + (2*l + 1)*wdth;
     for(i=0; i < 20; i++) {
       x = wdth*nd[i];
-      p1 += wt[i] * (f(cntr-x, k, df, nrng, q, isw)
-                     + f(cntr+x, k, df, nrng, q, isw));
+      r[2*i] = (cntr-x)*q;
+      r[2*i+1] = (cntr+x)*q;
+      g[2*i] = chi(cntr-x, df);
+      g[2*i+1] = chi(cntr+x, df);
     }
-    p += wdth*p1;
+    rng_lpv(r, 40, k, 16, lr);
+    for(i=0; i < 40; i++)
+      lr[i] = log(lr[i]);
 
-    if(isw == 0) {
-      su = ruq;
-      sl = sll;
+    for(j=0; j < nn; j++) {
+      if(nrng[j] < 1)
+        continue;
+      p1 = 0.0;
+      for(i=0; i < 20; i++)
+        p1 += wt[i] * (g[2*i]*exp(nrng[j]*lr[2*i])
+                       + g[2*i+1]*exp(nrng[j]*lr[2*i+1]));
+      p[j] += p1;
     }
   }
+  for(j=0; j < nn; j++)
+    if(nrng[j] > 0)
+      p[j] = pl.cnst*wdth*p[j] + tail;
+}
 
-  return (cnst*p);
+void smrng_lpf(double q, int k, const double *df, int ndf, int nrng,
+               double *p)
+{
+  struct smrng_plan pl;
+  int     i;
+
+  if(ndf < 1)
+    return;
+  plan_init(&pl, k, df[0], nrng, 16, 6);
+  for(i=0; i < ndf; i++) {
+    if(i > 0)
+      plan_df(&pl, df[i]);
+    p[i] = smrng_plan_lp(&pl, q);
+  }
 }
@@ -0,0 +1,143 @@
+/*
+ *  Test program for smrng_lp().
+ *    Command format: ./smrng_lp_tst [k [df]]
+ *
+ *  Arguments
+ *    [k]:  number of treatments (k <= 1 or omitted means
+ *          k = 2, 5, 20 and 100)
+ *    [df]: error degrees of freedom (df < 0 or omitted means
+ *          df = 1, 3, 10, 40, 240, 10000 and Inf)
+ *
+ *  Required functions:
+ *    extern double smrng_lp()
+ *    extern double smrng_lpd()
+ *    extern double smrng_up()
+ *    extern void   smrng_lpn()
+ *    extern void   smrng_lpf()
+ *    extern void   smrng_plan_init()
+ *    extern double smrng_plan_lp()
+ *    extern double smrng_plan_up()
+ *      extern double rng_lpt()
+ *        extern double nrml_pt()
+ *    static void   check()
+ *
+ *  Include files:
+ *    <stdio.h>
+ *    <stdlib.h>
+ *    <math.h>
+ *    "smrng_plan.h"
+ *
+ *  Note
+ *    1) For nrng = 1, 3 and 10, and q = 0.5, 1.0, ..., 12, it checks
+ *       that
+ *         smrng_plan_lp() and smrng_plan_up() by one plan for all q
+ *           are bit-identical to smrng_lp() and smrng_up(),
+ *         smrng_lp() + smrng_up() = 1 within TOLU,
+ *         the density of smrng_lpd() agrees with the finite
+ *           difference of smrng_lp() within TOLD,
+ *       and that smrng_lpn() for the list of nrng and smrng_lpf() for
+ *       the list of df agree with smrng_lp() in a loop within TOLN.
+ *       It prints the largest differences, and exits with 1 if a
+ *       check fails.
+ *    2) The finite difference is the 5-point one with h=DH.
+ *    3) The largest differences measured are 1.5e-11, 1.2e-8 and
+ *       1.6e-11 at k=100, and 2.0e-11, 2.5e-8 and 2.2e-11 at k=500
+ *       and df=240, for the last three checks.  The default lists
+ *       take about 30 seconds.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "smrng_plan.h"
+#define NQ    24      // number of q values
+#define DH    1.0e-3  // step of the finite difference
+#define TOLU  1.0e-10 // smrng_lp() + smrng_up() - 1
+#define TOLD  5.0e-8  // density - finite difference
+#define TOLN  1.0e-10 // smrng_lpn() or smrng_lpf() - smrng_lp()
+
+extern double smrng_lp(double q, int k, double df, int nrng);
+extern double smrng_lpd(double q, int k, double df, int nrng, double *pdf);
+extern double smrng_up(double q, int k, double df, int nrng);
+extern void smrng_lpn(double q, int k, double df, const int *nrng, int nn,
+                      double *p);
+extern void smrng_lpf(double q, int k, const double *df, int ndf,
+                      int nrng, double *p);
+extern void smrng_plan_init(struct smrng_plan *pl, int k, double df,
+                            int nrng, int acc, int mode);
+extern double smrng_plan_lp(struct smrng_plan *pl, double q);
+extern double smrng_plan_up(struct smrng_plan *pl, double q);
+
+static int nfail=0;
+
+static void check(const char *s, double e, double tol)
+{
+  printf("  %-26s %10.3e  %s\n", s, e, (e <= tol) ? "OK" : "NG");
+  if(!(e <= tol))
+    nfail++;
+}
+
+int main(int argc, char **argv)
+{
+  struct smrng_plan pl;
+  int     kl[4]={2, 5, 20, 100}, nl[3]={1, 3, 10};
+  double  dfl[7]={1.0, 3.0, 10.0, 40.0, 240.0, 10000.0, 0.0};
+  int     nk=4, ndf=7, i, j, l, m, nv;
+  double  q[NQ], p[7], x, y, fd, eu, ed, en;
+
+  if(argc >= 2 && atoi(argv[1]) > 1) {
+    kl[0] = atoi(argv[1]);
+    nk = 1;
+  }
+  if(argc >= 3 && atof(argv[2]) >= 0.0) {
+    dfl[0] = atof(argv[2]);
+    ndf = 1;
+  }
+  for(i=0; i < NQ; i++)
+    q[i] = 0.5*(i + 1);
+
+  for(j=0; j < nk; j++) {
+    printf("k = %i\n", kl[j]);
+    nv = 0;
+    eu = ed = en = 0.0;
+    for(l=0; l < ndf; l++)
+      for(m=0; m < 3; m++) {
+        smrng_plan_init(&pl, kl[j], dfl[l], nl[m], 16, 4);
+        for(i=0; i < NQ; i++) {
+          x = smrng_lp(q[i], kl[j], dfl[l], nl[m]);
+          y = smrng_up(q[i], kl[j], dfl[l], nl[m]);
+          nv += (smrng_plan_lp(&pl, q[i]) != x);
+          nv += (smrng_plan_up(&pl, q[i]) != y);
+          eu = fmax(eu, fabs(x + y - 1.0));
+          smrng_lpd(q[i], kl[j], dfl[l], nl[m], &y);
+          fd = (8.0*(smrng_lp(q[i] + DH, kl[j], dfl[l], nl[m])
+                     - smrng_lp(q[i] - DH, kl[j], dfl[l], nl[m]))
+                - (smrng_lp(q[i] + 2.0*DH, kl[j], dfl[l], nl[m])
+                   - smrng_lp(q[i] - 2.0*DH, kl[j], dfl[l], nl[m])))
+            /(12.0*DH);
+          ed = fmax(ed, fabs(y - fd));
+        }
+      }
+    for(i=0; i < NQ; i++) {
+      for(l=0; l < ndf; l++) {
+        smrng_lpn(q[i], kl[j], dfl[l], nl, 3, p);
+        for(m=0; m < 3; m++)
+          en = fmax(en, fabs(p[m] - smrng_lp(q[i], kl[j], dfl[l], nl[m])));
+      }
+      for(m=0; m < 3; m++) {
+        smrng_lpf(q[i], kl[j], dfl, ndf, nl[m], p);
+        for(l=0; l < ndf; l++)
+          en = fmax(en, fabs(p[l] - smrng_lp(q[i], kl[j], dfl[l], nl[m])));
+      }
+    }
+    check("plan - scalar (count)", (double)nv, 0.0);
+    check("lp + up - 1", eu, TOLU);
+    check("density - difference", ed, TOLD);
+    check("lpn, lpf - lp", en, TOLN);
+  }
+
+  printf("%s\n", (nfail == 0) ? "All checks passed." : "Some checks failed.");
+  exit ((nfail == 0) ? 0 : 1);
+}
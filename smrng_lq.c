@@ -1,23 +1,87 @@
 /*
- *  double smrng_lq(double p, int k, int df, int nrng,
+ *  double smrng_lq(double p, int k, double df, int nrng,
  *                  double xeps, double peps, int *itr)
  *    returns lower quantile of
  *    the Studentised range distribution.
+ *  double smrng_lqt(double p, int k, double df, int nrng,
+ *                   double xeps, double peps, int *itr, int acc,
+ *                   int method)
+ *    is smrng_lq() using smrng_lpt() with accuracy 10^(-acc).
+ *  double smrng_plan_lq(struct smrng_plan *pl, double p,
+ *                       double xeps, double peps, int *itr, int method)
+ *    returns lower quantile by a plan of smrng_plan_new().
+ *  double smrng_lqw(double p, int k, double df, int nrng,
+ *                   double xeps, double peps, int *itr,
+ *                   double x0, double xl, double xu)
+ *    is smrng_lq() starting from x0 with the bracket (xl, xu).
+ *  double smrng_plan_lqw(struct smrng_plan *pl, double p,
+ *                        double xeps, double peps, int *itr, int method,
+ *                        double x0, double xl, double xu)
+ *    is smrng_plan_lq() starting from x0 with the bracket (xl, xu).
+ *  double smrng_uq(double a, int k, double df, int nrng,
+ *                  double xeps, double peps, int *itr)
+ *    returns upper quantile (critical value at level a) of
+ *    the Studentised maximum range distribution.
+ *  double smrng_uqt(double a, int k, double df, int nrng,
+ *                   double xeps, double peps, int *itr, int acc,
+ *                   int method)
+ *    is smrng_uq() using smrng_upt() with accuracy 10^(-acc).
+ *  double smrng_plan_uq(struct smrng_plan *pl, double a,
+ *                       double xeps, double peps, int *itr, int method)
+ *    returns upper quantile by a plan of smrng_plan_new().
  *
  *  Arguments:
  *    p:    lower probability
+ *    a:    upper probability
  *    k:    number of treatments
- *    df:   error degrees of freedom (df<=0 means df=infinity)
+ *    df:   error degrees of freedom (df<=0 means df=infinity),
+ *          which need not be an integer
  *    nrng: number of independent ranges
  *    xeps: precision for quantile x
  *    peps: precision for probability p
- *    *itr: number of calls of smrng_lp()
+ *          (for -log(a) in the upper quantile)
+ *    *itr: number of calls of smrng_lp() (smrng_up())
+ *    acc:  accuracy of normal probabilities (see nrml_pt()).
+ *          smrng_lq() and smrng_uq() use acc=16.
+ *    pl:   plan for (k, df, nrng)
+ *    method: sum of one of
+ *            0 -> bisection and quadratic interpolation
+ *            1 -> Newton (Halley) steps with the density (see Note 4)
+ *            2 -> ITP method (see Note 7)
+ *          and the flag
+ *            4 -> first values of low accuracy (see Note 8)
+ *          smrng_lq() and smrng_uq() use method=5, and smrng_lqw()
+ *          method=1.
+ *    x0:   first point of the search (x0<=0 means the initial guess
+ *          of Note 5), such as the quantile for the neighbouring
+ *          parameters
+ *    xl, xu: quantile lies in (xl, xu) (not known if xl<=0 or xu<=xl),
+ *          used only with method=1 or 5 (see Note 6)
  *
  *  Required functions:
- *    extern double smrng_lp()
+ *    extern void   smrng_plan_init()
+ *    extern double smrng_plan_lpd()
+ *    extern double smrng_plan_upd()
+ *    extern void   smrng_plan_par()
+ *    extern double rng_lpd()
+ *    extern double rng_upt()
+ *    extern double chi2_q()
+ *    extern double nrml_pt()
+ *    extern double nrml_q()
+ *    static double trigam()
+ *    static double rq()
+ *    static double guess()
+ *    static double val()
+ *    static double probe()
+ *    static void   nwt_init()
+ *    static int    nwt_step()
+ *    static double solve()
+ *    static double solvef()
  *
  *  Include files:
  *    <math.h>
+ *    <stddef.h>
+ *    "smrng_plan.h"
  *
  *  Note
  *    1) Solves the root of quadratic interpolation.
@@ -27,6 +91,79 @@
  *         using an automatic computer",
  *         Mathematical Tables and Other Aids to Computation,
  *         Vol. 10, 208-215.
+ *    2) smrng_lq() and smrng_lqt() make a local plan for (k, df, nrng)
+ *       by smrng_plan_init(), as smrng_lpt() does.  With method=0 or
+ *       2, the plan is of the r-grid mode with the large-df expansion
+ *       (mode=6 of smrng_plan_new()), so that range probabilities are
+ *       reused by all iterations.  With method=1 or 5, the few calls
+ *       (Note 5) do not pay for filling the r-grid, and the plan is
+ *       of mode=4.
+ *    3) smrng_uq() solves -log(smrng_up(x))=-log(a) by the same
+ *       iterations.  It keeps the relative accuracy of small a, for
+ *       which p=1-a of smrng_lq() has no significant digits below
+ *       1e-12, and -log(smrng_up(x)) is nearly quadratic in x, so
+ *       that the quadratic interpolation converges fast.  Each call of
+ *       smrng_up() takes much longer than that of smrng_lp(); use
+ *       smrng_lq() for a > 1e-6 or so.
+ *    4) With method=1, each call of smrng_lp() (smrng_up()) also
+ *       returns the density (smrng_plan_lpd(), smrng_plan_upd()),
+ *       which takes about twice the time (Note 11 of smrng_lp.c).
+ *       After the bracket is found, Newton steps are taken from its
+ *       upper end.  The step is corrected to Halley's by the curvature
+ *       from the densities at the last two points.  Bisection is taken
+ *       instead if the step leaves the bracket or if it does not halve
+ *       the bracket as fast as bisection would (rtsafe() of Numerical
+ *       Recipes).  The iteration stops when the step is below xeps (and
+ *       the error of p is below peps), and the stepped point is
+ *       returned, so that it takes about 5 calls in all instead of 10
+ *       to 50 with method=0.
+ *    5) The search starts from an approximate quantile (guess()).
+ *       The quantile of the maximum range R for df=infinity and that
+ *       of s=sqrt(chi^2/df) are computed by Newton's method, and the
+ *       normal score z of p is split into z_r for log(R) and z_s for
+ *       -log(s) with z_r^2+z_s^2=z^2 in proportion to their standard
+ *       deviations (the slope of the quantile of R, and
+ *       sqrt(psi'(df/2))/2 for log(s)).  The guess is within 10% of
+ *       the quantile for usual p, and within 30% for a=1e-20.  The
+ *       bracket is searched from there by relative steps of 5%, 10%,
+ *       20%, ... (method=0) or by Newton steps lengthened by 20%
+ *       (method=1).
+ *    6) smrng_lqw() is for a sweep of parameters, as in smrng_tbl.c.
+ *       The quantile increases in k and nrng and decreases in df, so
+ *       that those for the neighbouring parameters give x0 and the
+ *       bracket (xl, xu).  Then the bracket search is not needed and
+ *       the Newton steps start from x0, which is usually a call or two
+ *       less than from the guess.  With method=0, the probabilities
+ *       at xl and xu would be required, and the bracket is not used.
+ *    7) With method=2, the bracket (x1, x2) is narrowed by the ITP
+ *       (interpolate, truncate and project) method, which needs no
+ *       density.  The regula falsi point is moved toward the midpoint
+ *       by 0.2*(x2-x1)^2/(initial width) and projected to within
+ *       xeps*2^(n-j-1)-(x2-x1)/2 of it at the j-th step, where n is
+ *       the number of bisections to reach the width xeps, plus one.
+ *       Then it never takes more than n calls after the bracket,
+ *       while the convergence is superlinear for smooth val().  It
+ *       stops when x2-x1 < xeps, or when the last step is below xeps
+ *       and the error of p is below peps (regula falsi converges from
+ *       one side).  It takes about 9 calls in all, against 13 (up to
+ *       50) with method=0.
+ *       References
+ *         Oliveira, I. F. D. and R. H. C. Takahashi (2020).
+ *         "An enhancement of the bisection method average performance
+ *         preserving minmax optimality",
+ *         ACM Transactions on Mathematical Software, Vol. 47, 1-24.
+ *    8) With method & 4, the values far from p are taken by another
+ *       plan of accuracy 10^(-ACCLO) (mode=4), whose errors are of
+ *       order e-6 (relative for -log(a)).  It is used until a value
+ *       within PSW of p is met; a value within PCRS of p, whose sign
+ *       of val-p may be wrong, is taken again with the full accuracy.
+ *       The last steps and the stopping tests use the full accuracy
+ *       only, so xeps and peps hold as without the flag.  The values
+ *       of low accuracy cost about 60% of the full ones for the lower
+ *       probability (mode=4), and much less for the upper probability,
+ *       since the tolerance of adapt() follows acc.  It saves about
+ *       10% of time for smrng_lq() and 30% for smrng_uq().  It does
+ *       not pay for smrng_lqw() with a good starting point.
  *
  *  Stored in:
  *    smrng_lq.c
@@ -35,6 +172,19 @@
  *    c. 1994:    First written in Fortran.
  *    2018-11-11: Created for the new version.
  *    2021-05-11: Modified for Studentised maximum range.
+ *    2026-10-16: Accuracy of normal probabilities is selectable.
+ *                One plan of smrng_lp() for the whole search.
+ *                Range probabilities on the r-grid of the plan.
+ *                Real-valued df.
+ *                Large-df expansion of smrng_lp().
+ *                smrng_uq() for upper quantile by smrng_up().
+ *                Newton (Halley) steps with the density (method=1).
+ *                Initial guess from the quantiles of the range and
+ *                of the chi.
+ *                smrng_lqw() with a starting point and a bracket.
+ *                ITP method (method=2).
+ *                First values of low accuracy (method & 4).
+ *                Plans on the stack by smrng_plan_init().
  *
  *  License
  *    GPLv3 (Free and No Warranty)
@@ -45,38 +195,329 @@
 
 
 #include  <math.h>
+#include  <stddef.h>
+#include  "smrng_plan.h"
 #define   YEPS  1.0e-12 // accuracy of Studentised range probabilities
+#define   DXG   0.05    // first relative step from the initial guess
+#define   ITPK1 0.2     // truncation 0.2*(x2-x1)^2/(initial width) of ITP
+#define   ACCLO 6       // accuracy of the first values with method & 4
+#define   PSW   1.0e-3  // |val-p| below which the full accuracy is used
+#define   PCRS  1.0e-4  // |val-p| of low accuracy to be taken again
+#define   CNST0 0.398942280401432677939946059934381868  // 1/sqrt(2*pi)
 
-extern double smrng_lp(double q, int k, int df, int nrng);
+extern void smrng_plan_init(struct smrng_plan *pl, int k, double df, int nrng,
+                            int acc, int mode);
+extern double smrng_plan_lpd(struct smrng_plan *pl, double q, double *pdf);
+extern double smrng_plan_upd(struct smrng_plan *pl, double q, double *pdf);
+extern void smrng_plan_par(const struct smrng_plan *pl, int *k, double *df,
+                           int *nrng);
+extern double rng_lpd(double r, int k, int acc, double *d);
+extern double rng_upt(double r, int k, int acc);
+extern double chi2_q(double t, double df, int upper);
+extern double nrml_pt(double u, int upper, int acc);
+extern double nrml_q(double p, int upper);
 
+/* Trigamma function psi'(x) for x > 0.
+ */
+static double trigam(double x)
+{
+  double  y=0.0, x2;
 
-double smrng_lq(double p, int k, int df, int nrng,
-                double xeps, double peps, int *itr)
+  for( ; x < 6.0; x += 1.0)
+    y += 1.0/(x*x);
+  x2 = 1.0/(x*x);
+  return(y + 1.0/x + 0.5*x2
+         + x2/x*(1.0/6.0 - x2*(1.0/30.0 - x2*(1.0/42.0 - x2/30.0))));
+}
+
+/* Quantile of max range rng_lp(r, k)^nrng (df=infinity) with lower
+ * (upper==0) or upper (upper!=0) probability t by Newton's method
+ * in log(r), and the slope phi(z)/(r F'(r)) of log(r) in the normal
+ * score z in *sl.
+ */
+static double rq(double t, int k, int nrng, int upper, double r, double *sl)
 {
-  double  x1, x2, x3, y1, y2, y3;
-  double  a, b, x, y;
+  double  y, u, g, dr;
   int     i;
 
-  (*itr) = 0;
-  if(p <= 0.0)
-    return (0.0);
-  if(p >= 1.0)
-    return (1.0e+99);
+  for(i=0; i < 30; i++) {
+    y = rng_lpd(r, k, 16, &g);
+    if(upper && y > 0.5)
+      u = -expm1(nrng*log1p(-rng_upt(r, k, 16)));
+    else
+      u = upper ? 1.0 - pow(y, (double)nrng) : pow(y, (double)nrng);
+    g *= nrng*pow(y, nrng - 1.0);   // F'(r)
+    if(upper)
+      dr = -(log(u) - log(t))/(r*g/u);
+    else
+      dr = (log(u) - log(t))/(r*g/u);
+    // Underflow: F=0 (1-F=0) below (above) the quantile.
+    if(!(g > 0.0) || !(u > 0.0))
+      dr = upper ? 0.5 : -0.5;
+    dr = fmax(-0.5, fmin(0.5, dr));
+    r *= exp(-dr);
+    if(fabs(dr) < 1.0e-4)
+      break;
+  }
+  y = rng_lpd(r, k, 16, &g);
+  g *= nrng*pow(y, nrng - 1.0);
+  u = nrml_q(t, upper);
+  *sl = (g > 0.0) ? (CNST0)*exp(-0.5*u*u)/(r*g) : 0.1;
+  return(r);
+}
+
+/* Approximate quantile of q=r/s with lower (upper==0) or upper
+ * (upper!=0) probability t.  With the normal score z of t, z_r and
+ * z_s with z_r^2+z_s^2=z^2 are allotted to log(r) and -log(s) in
+ * proportion to their standard deviations (exact if both are normal).
+ */
+static double guess(const struct smrng_plan *pl, double t, int upper)
+{
+  double  df, z, r, sr, ss, s, zr, zs;
+  int     k, nrng;
+
+  smrng_plan_par(pl, &k, &df, &nrng);
+
+  z = nrml_q(t, upper);
+  r = rq(t, k, nrng, upper, 2.0*nrml_q(0.5/(k*nrng), 1), &sr);
+  if(df <= 0.0)
+    return(r);
+  ss = 0.5*sqrt(trigam(0.5*df));
+  s = sqrt(sr*sr + ss*ss);
+  zr = z*sr/s;
+  zs = z*ss/s;
+  r = rq(nrml_pt(fabs(zr), 1, 16), k, nrng, zr > 0.0, r, &sr);
+  s = sqrt(chi2_q(nrml_pt(fabs(zs), 1, 16), df, zs < 0.0)/df);
+  return(r/s);
+}
+
+/* Increasing function of x to be solved
+ *   smrng_lp(x) (upper == 0) or -log(smrng_up(x)) (upper != 0)
+ * and its derivative in *d unless d == NULL.
+ */
+static double val(struct smrng_plan *pl, double x, int upper, double *d)
+{
+  double  y;
+
+  if(upper) {
+    y = smrng_plan_upd(pl, x, d);
+    if(d != NULL)
+      *d = (y > 0.0) ? *d/y : 0.0;
+    return(-log(y));
+  }
+  return(smrng_plan_lpd(pl, x, d));
+}
+
+/* val() by the plan pc of low accuracy while *lo != 0 (until
+ * |val-p| < PSW) and by pl after that.  A value of pc within PCRS of p
+ * is taken again by pl.
+ */
+static double probe(struct smrng_plan *pl, struct smrng_plan *pc, int *lo,
+                    double x, double p, int upper, double *d, int *itr)
+{
+  double  y;
 
-  // x1 < x2 (x3 <= x1 or x2 <= x3)
-  // y1 < p <= y2
-  x1 = 0.0;
-  y1 = 0.0;
-  x2 = 2.0;
-  y2 = smrng_lp(x2, k, df, nrng);
   (*itr)++;
-  while(y2 < p) {
-    x1 = x2;
-    y1 = y2;
-    x2 *= 2.0;
-    y2 = smrng_lp(x2, k, df, nrng);
+  if(*lo) {
+    y = val(pc, x, upper, d);
+    if(fabs(y - p) >= PCRS) {
+      if(fabs(y - p) < PSW)
+        *lo = 0;
+      return(y);
+    }
+    *lo = 0;
     (*itr)++;
   }
+  return(val(pl, x, upper, d));
+}
+
+/* State of a Newton search (method == 1) for val(x)=p, which is
+ * advanced by nwt_step() with val() and its derivative at x.
+ */
+struct nwt {
+  double  p, x, x1, x2, xo, d, dold, dx, h;
+  int     i, stage;   // 0: bracket search, 1: Newton steps
+};
+
+/* Starts the search from x within (xl, xu) if xl > 0 and xu > xl.
+ */
+static void nwt_init(struct nwt *s, double p, double x, double xl,
+                     double xu)
+{
+  s->p = p;
+  s->x = x;
+  s->x1 = 0.0;
+  s->x2 = -1.0;
+  s->d = 0.0;
+  if(xl > 0.0 && xu > xl) {
+    s->x1 = xl;
+    s->x2 = xu;
+    if(x <= s->x1 || x >= s->x2)
+      s->x = 0.5*(s->x1 + s->x2);
+  }
+  s->h = DXG;
+  s->i = 0;
+  s->stage = 0;
+}
+
+/* Takes y=val(x) and d=val'(x) at s->x.  Returns 1 with the next
+ * point in s->x, or 0 with the root in s->x.
+ */
+static int nwt_step(struct nwt *s, double y, double d, double xeps,
+                    double peps)
+{
+  double  p=s->p, x=s->x, g, h, xn;
+
+  // x1 < x2, val(x1) < p <= val(x2)
+  // The bracket is searched from the initial guess by Newton steps
+  // lengthened by 20%, or by relative steps of DXG, 2*DXG, ...
+  if(s->stage == 0) {
+    if(y >= p)
+      s->x2 = x;
+    else
+      s->x1 = x;
+    if(!(s->x2 > 0.0 && (s->x1 > 0.0 || s->i >= 60))) {
+      if(d > 0.0) {
+        // The guess may be good enough.
+        if(fabs(p - y) < xeps*d && fabs(p - y) < peps) {
+          s->x = x + (p - y)/d;
+          return(0);
+        }
+        xn = x + 1.2*(p - y)/d;
+        if(fabs(xn - x) < xeps)
+          xn = x + ((y < p) ? xeps : -xeps);
+      }
+      else
+        xn = (y < p) ? x*(1.0 + s->h) : x/(1.0 + s->h);
+      s->x = fmax(0.5*x, fmin(2.0*x, xn));
+      s->h *= 2.0;
+      s->i++;
+      return(1);
+    }
+    s->stage = 1;
+    s->xo = x;
+    s->dold = d;
+    s->dx = s->x2 - s->x1;
+    s->i = 1;
+  }
+  else {
+    if(y >= p)
+      s->x2 = x;
+    else
+      s->x1 = x;
+    if(++(s->i) >= 201)
+      return(0);
+  }
+
+  // Newton steps (Halley's with the curvature from the last two
+  // densities) from the last point, and bisection if the step leaves
+  // (x1, x2) or does not halve the bracket (rtsafe() of Numerical
+  // Recipes).
+  g = y - p;
+  if(d <= 0.0 || ((x - s->x1)*d - g)*((x - s->x2)*d - g) > 0.0
+     || fabs(2.0*g) > fabs(s->dx*d)) {
+    s->dx = 0.5*(s->x2 - s->x1);
+    xn = s->x1 + s->dx;
+  }
+  else {
+    s->dx = -g/d;
+    if(x != s->xo) {
+      h = d*d - 0.5*g*(d - s->dold)/(x - s->xo);
+      if(h > 0.5*d*d && x - g*d/h > s->x1 && x - g*d/h < s->x2)
+        s->dx = -g*d/h;
+    }
+    xn = x + s->dx;
+  }
+  if(fabs(s->dx) < xeps && fabs(g) < peps) {
+    s->x = xn;
+    return(0);
+  }
+  s->xo = x;
+  s->dold = d;
+  s->x = xn;
+  return(1);
+}
+
+/* Solves val(x)=p with val(0)=0 from x0 (guess() if x0 <= 0) within
+ * (xl, xu) if xl > 0 and xu > xl (method == 1 only).  The first
+ * values are taken by pc unless pc == NULL.
+ */
+static double solve(struct smrng_plan *pl, struct smrng_plan *pc,
+                    double p, int upper, double xeps, double peps,
+                    int *itr, int method, double x0, double xl, double xu)
+{
+  struct nwt s;
+  double  x1, x2, x3, y1, y2, y3;
+  double  a, b, x, y, d, g, dx, xn, xo, h;
+  int     i, lo=(pc != NULL);
+
+  x = (x0 > 0.0) ? x0 : guess(pl, (upper ? exp(-p) : p), upper);
+  if(!(x > 0.0 && x < 1.0e+99))
+    x = 2.0;
+
+  if(method == 1) {
+    nwt_init(&s, p, x, xl, xu);
+    do
+      y = probe(pl, pc, &lo, s.x, p, upper, &d, itr);
+    while(nwt_step(&s, y, d, xeps, peps));
+    return(s.x);
+  }
+
+  // x1 < x2 (x3 <= x1 or x2 <= x3)
+  // y1 < p <= y2
+  // The bracket is searched from the initial guess by steps of
+  // DXG, 2*DXG, 4*DXG, ... (relative).
+  x1 = y1 = 0.0;
+  x2 = y2 = -1.0;
+  for(h=DXG, i=0; ; h *= 2.0, i++) {
+    y = probe(pl, pc, &lo, x, p, upper, NULL, itr);
+    if(y >= p) {
+      x2 = x;
+      y2 = y;
+    }
+    else {
+      x1 = x;
+      y1 = y;
+    }
+    if(x2 > 0.0 && (x1 > 0.0 || i >= 60))
+      break;
+    xn = (y < p) ? x*(1.0 + h) : x/(1.0 + h);
+    x = fmax(0.5*x, fmin(2.0*x, xn));
+  }
+
+  // ITP steps: regula falsi truncated toward the midpoint and
+  // projected into the minmax interval of bisection.
+  if(method == 2) {
+    h = x2 - x1;
+    xo = x;
+    i = (int)ceil(log2(h/xeps));
+    for(dx=xeps*ldexp(1.0, (i > 0) ? i : 0); x2 - x1 > xeps; dx *= 0.5) {
+      xn = 0.5*(x1 + x2);
+      x = (y2 > y1) ? x1 + (p - y1)*(x2 - x1)/(y2 - y1) : xn;
+      g = ITPK1*(x2 - x1)*(x2 - x1)/h;
+      if(g <= fabs(xn - x))
+        x += (xn > x) ? g : -g;
+      else
+        x = xn;
+      g = dx - 0.5*(x2 - x1);
+      if(fabs(x - xn) > g)
+        x = xn - ((xn > x) ? g : -g);
+      y = probe(pl, pc, &lo, x, p, upper, NULL, itr);
+      if(y == p || (fabs(x - xo) < xeps && fabs(y - p) < peps))
+        return(x);
+      xo = x;
+      if(y >= p) {
+        x2 = x;
+        y2 = y;
+      }
+      else {
+        x1 = x;
+        y1 = y;
+      }
+    }
+    return((y2 > y1) ? x1 + (p - y1)*(x2 - x1)/(y2 - y1) : 0.5*(x1 + x2));
+  }
+
   x3 = x2;  // (x3, y3) is used for quadratic interpolation.
   y3 = y2;
 
@@ -100,8 +541,7 @@ double smrng_lq(double p, int k, int df, int nrng,
         x = 0.5*(x1 + x2);
     }
 
-    y = smrng_lp(x, k, df, nrng);
-    (*itr)++;
+    y = probe(pl, pc, &lo, x, p, upper, NULL, itr);
     if(fabs(x2 - x1) < xeps && fabs(y - p) < peps)
       break;
 
@@ -120,3 +560,96 @@ double smrng_lq(double p, int k, int df, int nrng,
   }
   return(x);
 }
+
+/* solve() with method & 3, and with the first values by a plan of
+ * accuracy 10^(-ACCLO) if method & 4.
+ */
+static double solvef(struct smrng_plan *pl, double p, int upper,
+                     double xeps, double peps, int *itr, int method,
+                     double x0, double xl, double xu)
+{
+  struct smrng_plan pc;
+  double  df;
+  int     k, nrng;
+
+  if(!(method & 4))
+    return(solve(pl, NULL, p, upper, xeps, peps, itr, method & 3,
+                 x0, xl, xu));
+  smrng_plan_par(pl, &k, &df, &nrng);
+  smrng_plan_init(&pc, k, df, nrng, ACCLO, 4);
+  return(solve(pl, &pc, p, upper, xeps, peps, itr, method & 3, x0, xl, xu));
+}
+
+double smrng_plan_lq(struct smrng_plan *pl, double p,
+                     double xeps, double peps, int *itr, int method)
+{
+  (*itr) = 0;
+  if(p <= 0.0)
+    return (0.0);
+  if(p >= 1.0)
+    return (1.0e+99);
+  return(solvef(pl, p, 0, xeps, peps, itr, method, 0.0, 0.0, 0.0));
+}
+
+double smrng_plan_lqw(struct smrng_plan *pl, double p,
+                      double xeps, double peps, int *itr, int method,
+                      double x0, double xl, double xu)
+{
+  (*itr) = 0;
+  if(p <= 0.0)
+    return (0.0);
+  if(p >= 1.0)
+    return (1.0e+99);
+  return(solvef(pl, p, 0, xeps, peps, itr, method, x0, xl, xu));
+}
+
+double smrng_plan_uq(struct smrng_plan *pl, double a,
+                     double xeps, double peps, int *itr, int method)
+{
+  (*itr) = 0;
+  if(a >= 1.0)
+    return (0.0);
+  if(a <= 0.0)
+    return (1.0e+99);
+  return(solvef(pl, -log(a), 1, xeps, peps, itr, method, 0.0, 0.0, 0.0));
+}
+
+double smrng_lqt(double p, int k, double df, int nrng,
+                 double xeps, double peps, int *itr, int acc, int method)
+{
+  struct smrng_plan pl;
+
+  smrng_plan_init(&pl, k, df, nrng, acc, ((method & 3) == 1) ? 4 : 6);
+  return(smrng_plan_lq(&pl, p, xeps, peps, itr, method));
+}
+
+double smrng_lq(double p, int k, double df, int nrng,
+                double xeps, double peps, int *itr)
+{
+  return(smrng_lqt(p, k, df, nrng, xeps, peps, itr, 16, 5));
+}
+
+double smrng_lqw(double p, int k, double df, int nrng,
+                 double xeps, double peps, int *itr,
+                 double x0, double xl, double xu)
+{
+  struct smrng_plan pl;
+
+  smrng_plan_init(&pl, k, df, nrng, 16, 4);
+  return(smrng_plan_lqw(&pl, p, xeps, peps, itr, 1, x0, xl, xu));
+}
+
+double smrng_uqt(double a, int k, double df, int nrng,
+                 double xeps, double peps, int *itr, int acc, int method)
+{
+  struct smrng_plan pl;
+
+  smrng_plan_init(&pl, k, df, nrng, acc, 0);
+  return(smrng_plan_uq(&pl, a, xeps, peps, itr, method));
+}
+
+double smrng_uq(double a, int k, double df, int nrng,
+                double xeps, double peps, int *itr)
+{
+  return(smrng_uqt(a, k, df, nrng, xeps, peps, itr, 16, 5));
+}
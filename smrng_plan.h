@@ -0,0 +1,49 @@
+/*
+ *  struct smrng_plan
+ *    plan of smrng_lp.c for fixed (k, df, nrng), so that a caller can
+ *    keep it on the stack and set it by smrng_plan_init().
+ *
+ *  Note
+ *    1) The members are set only by the functions of smrng_lp.c.
+ *       Other files use the plan through those functions and do not
+ *       read or write the members.
+ *
+ *  Stored in:
+ *    smrng_plan.h
+ *
+ *  History
+ *    2026-10-16: Moved from smrng_lp.c for plans on the stack.
+ *                Full limits kept for smrng_plan_eps().
+ *
+ *  License
+ *    GPLv3 (Free and No Warranty)
+ *    https://www.gnu.org/licenses/
+ *
+ *  Coded by Tetsuhisa Miwa.
+ */
+
+
+#ifndef SMRNG_PLAN_H
+#define SMRNG_PLAN_H
+#define NPNL      16  // number of panels of the r-grid
+
+/* Values that do not depend on q.
+ */
+struct smrng_plan {
+  int     k, nrng, acc, mode;
+  double  df;
+  double  sl, su;   // limits of s=sqrt(chi^2/df)
+  double  sl0, su0; // limits of s before smrng_plan_eps()
+  double  cnst;     // coef(df)
+  double  rl, ru;   // limits of max range
+  double  ru0;      // ru before smrng_plan_eps()
+  double  eps;      // absolute error required (0 if not set)
+  int     ne;       // ne-point rule of smrng_plan_eps() (0: 40 nodes)
+  int     ng;       // g[] is set or not
+  double  g[40];    // chi(s, df) at the nodes on (sl, su)
+  int     nr[NPNL];         // rg[j][] (1) and rd[j][] (2) are set or not
+  double  rg[NPNL][40];     // rng_lp(r, k)^nrng at the nodes of panel j
+  double  rd[NPNL][40];     // its derivative F'(r) at the same nodes
+  double  gz[15], gw[15];   // Gauss rules of gauss() of smrng_lp.c
+};
+#endif
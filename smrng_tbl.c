@@ -2,7 +2,7 @@
  *  This program tabulates the upper quantiles
  *    of the Studentised maximum range distribution.
  *
- *  command format: smrng_tbl k_end alpha [index [nrng]]
+ *  command format: smrng_tbl k_end alpha [index [nrng [nthreads]]]
  *
  *  Arguments
  *    k_end:   k = 2, ..., k_end.
@@ -10,23 +10,61 @@
  *               k = 2, ..., 20, 50, 100, 200, 500, 1000.
  *    alpha:   upper probability
  *    [index]: If index==2, df runs from 1 to 40.
- *    [nrng]:  number of independent ranges
+ *    [nrng]:  number of independent ranges, or a comma-separated
+ *             list of them such as 1,2,5,10 (one table for each,
+ *             at most 32 positive values)
+ *    [nthreads]: number of threads (0 or omitted means the number
+ *             of processors online)
  *
  *  Required functions:
- *    extern double smrng_lq()
- *      extern double smrng_lp()
- *        extern double rng_lp()
- *          extern double nrml_p()
+ *    extern struct smrng_plan *smrng_plan_new()
+ *    extern void   smrng_plan_free()
+ *    extern void   smrng_plan_df()
+ *    extern double smrng_plan_lqw()
+ *      extern double smrng_plan_lp()
+ *        extern void rng_lpv()
+ *          extern void nrml_lipv()
+ *    static int  pick(struct table *t)
+ *    static void *worker(void *arg)
  *    static void line(int i)
  *
  *  Include files:
  *    <stdio.h>
  *    <stdlib.h>
  *    <math.h>
+ *    <pthread.h>
+ *    <unistd.h>
  *
  *  Note
- *    The table can be stored in a file by piping such as
- *      ./smrng_tbl 20 0.05 2 10 > smrng05.txt
+ *    1) The table can be stored in a file by piping such as
+ *         ./smrng_tbl 20 0.05 2 10 > smrng05.txt
+ *    2) The quantile increases in k and decreases in df (df=Inf is
+ *       the last row).  Each quantile is solved by smrng_plan_lqw()
+ *       in the bracket of the left and upper neighbours, starting
+ *       from q(left)*q(upper)/q(upper left).  It takes about 3 calls
+ *       of smrng_plan_lp() for each quantile instead of 4 or 5 from
+ *       the initial guess of smrng_lq().
+ *    3) All cells are computed by nthreads threads before the table
+ *       is printed.  A cell is ready when its left and upper
+ *       neighbours are done, and the ready cell of the largest k
+ *       (then the smallest df) is taken first, since the time of
+ *       smrng_lp() grows with k.  Each cell is solved from the same
+ *       neighbours as in the serial order, so the output does not
+ *       depend on nthreads.
+ *    4) With a list of nrng values, the tables are printed one after
+ *       another in the order of the list, each as for a single nrng.
+ *    5) Each column has one plan of mode=6 (r-grid and large-df
+ *       expansion), whose df is changed by smrng_plan_df() from row
+ *       to row, so that the range probabilities on the r-grid are
+ *       computed once for the column (see Note 14 of smrng_lp.c).
+ *       The cells of a column are never solved at the same time,
+ *       since each waits for the upper one.  The table is the same
+ *       as by smrng_lqw() and takes about 1/4 of the time.
+ *    6) The worker threads call only reentrant library functions:
+ *       exp, expm1, log, log1p, log10, pow, sqrt, tgamma, fabs,
+ *       floor, ceil, fmin, fmax, malloc and free.  lgamma() must not
+ *       be used (it writes the global signgam), nor the cache of
+ *       rng_lpc() (mode & 1), which is a static list.
  *
  *  Stored in:
  *    smrng_tbl.c
@@ -36,6 +74,12 @@
  *    2018-11-10: Created for the new version.
  *    2019-04-26: k_end > 100
  *    2021-05-12: Studentised maximum range
+ *    2026-10-16: Warm start from the neighbours by smrng_lqw().
+ *                Cells computed by several threads.
+ *                List of nrng values in one run.
+ *                One r-grid plan for each column.
+ *                Reentrant library calls only (Note 6).
+ *                Checks of the list of nrng values.
  *
  *  Coded by Tetsuhisa Miwa.
  */
@@ -44,10 +88,89 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
+#include <unistd.h>
 #define EPS (1.0e-8)
+#define NDF   46   // maximum number of df rows
+#define NK    99   // maximum number of k columns
+#define NTHR  64   // maximum number of threads
+#define NNRNG 32   // maximum number of nrng values
 
-extern double smrng_lq(double p, int k, int df, int nrng,
-                       double xeps, double peps, int *itr);
+struct smrng_plan;
+extern struct smrng_plan *smrng_plan_new(int k, double df, int nrng, int acc,
+                                         int mode);
+extern void smrng_plan_free(struct smrng_plan *pl);
+extern void smrng_plan_df(struct smrng_plan *pl, double df);
+extern double smrng_plan_lqw(struct smrng_plan *pl, double p,
+                             double xeps, double peps, int *itr, int method,
+                             double x0, double xl, double xu);
+
+// cells of the table shared by the threads
+struct table {
+  int     nk, ndf, k[NK], df[NDF], nrng;
+  double  alpha, xeps, peps, q[NDF][NK];
+  int     itr[NDF][NK];
+  char    st[NDF][NK];  // 0: waiting, 1: running, 2: done
+  int     left;         // number of cells not yet taken
+  struct smrng_plan *pl[NK];  // r-grid plan of each column
+  pthread_mutex_t mtx;
+  pthread_cond_t  cnd;
+};
+
+/* Returns the ready cell i*nk + j of the largest k, or -1 if no cell
+ * is ready.  t->mtx must be locked.
+ */
+static int pick(struct table *t)
+{
+  int     i, j;
+
+  for(j=t->nk - 1; j >= 0; j--)
+    for(i=0; i < t->ndf; i++)
+      if(t->st[i][j] == 0) {
+        if((j == 0 || t->st[i][j - 1] == 2)
+           && (i == 0 || t->st[i - 1][j] == 2))
+          return(i*t->nk + j);
+        break;  // the cells below wait for this one
+      }
+  return(-1);
+}
+
+static void *worker(void *arg)
+{
+  struct table *t=arg;
+  double  q, x0, xl, xu;
+  int     i, j, c, itr;
+
+  pthread_mutex_lock(&t->mtx);
+  while(t->left > 0) {
+    if((c = pick(t)) < 0) {
+      pthread_cond_wait(&t->cnd, &t->mtx);
+      continue;
+    }
+    i = c/t->nk;
+    j = c%t->nk;
+    t->st[i][j] = 1;
+    t->left--;
+    // q(k[j-1], df[i]) < q < q(k[j], df[i-1])
+    xl = (j > 0) ? t->q[i][j - 1] : 0.0;
+    xu = (i > 0) ? t->q[i - 1][j] : 0.0;
+    x0 = (i > 0 && j > 0) ? xl*xu/t->q[i - 1][j - 1] : 0.0;
+    pthread_mutex_unlock(&t->mtx);
+
+    // The cells of a column are taken in order of df, one at a time.
+    smrng_plan_df(t->pl[j], t->df[i]);
+    q = smrng_plan_lqw(t->pl[j], 1.0-t->alpha, t->xeps, t->peps, &itr,
+                       1, x0, xl, xu);
+
+    pthread_mutex_lock(&t->mtx);
+    t->q[i][j] = q;
+    t->itr[i][j] = itr;
+    t->st[i][j] = 2;
+    pthread_cond_broadcast(&t->cnd);
+  }
+  pthread_mutex_unlock(&t->mtx);
+  return(NULL);
+}
 
 static void line(int i)
 {
@@ -58,31 +181,35 @@ static void line(int i)
 
 int main(int argc, char **argv)
 {
-  double  alpha, xeps, peps, q;
-  int     kupper[5]={50, 100, 200, 500, 1000}, k[99], ke, j;
-  int     index=1, nrng=1, df[106], i, itr, itrmax=0;
+  static struct table t;
+  pthread_t thr[NTHR];
+  double  q;
+  int     kupper[5]={50, 100, 200, 500, 1000}, ke, j;
+  int     index=1, nthr=0, i, itrmax, nrng[NNRNG]={1}, nn=1, l;
+  char    *c, *s;
   FILE    *fout;
 
   if(argc < 3) {
-    printf("command format: smrng_tbl k_end alpha [index [nrng]]\n");
+    printf("command format: "
+           "smrng_tbl k_end alpha [index [nrng [nthreads]]]\n");
     exit(1);
   }
 
   ke = atoi(argv[1]) - 2; // end value of k
   if(ke <= 98) {
     for(j=0; j <= ke; j++)
-      k[j] = j + 2;
+      t.k[j] = j + 2;
   } else {
     ke = 23;
     for(j=0; j <= 18; j++)
-      k[j] = j + 2;
+      t.k[j] = j + 2;
     for( ; j <= ke; j++)
-      k[j] = kupper[j - 19];
+      t.k[j] = kupper[j - 19];
   }
 
-  alpha = atof(argv[2]);
-  xeps = EPS;
-  peps = alpha*EPS;
+  t.alpha = atof(argv[2]);
+  t.xeps = EPS;
+  t.peps = t.alpha*EPS;
 
   if(argc >= 4) {
     index = atoi(argv[3]);
@@ -90,51 +217,110 @@ int main(int argc, char **argv)
       index = 2;
   }
   for(i=0; i < 20*index; i++)
-    df[i] = i + 1;
+    t.df[i] = i + 1;
   for(i=0; i < 5; i++)
-    df[i + 20*index] = 120*index/(5 - i);
-  df[5 + 20*index] = 0;
-
-  if(argc >= 5)
-    nrng = atoi(argv[4]);
-  
-  printf("The Studentised maximum range upper quantiles\n"
-         "q(k, df, no.ranges=%4i; alpha=%5.2lf)\n", nrng, alpha);
-  line(7*ke + 12);
-  printf(" df  k->%3i", k[0]);
-  for(j=1; j <= ke; j++)
-    printf("%7i", k[j]);
-  printf("\n");
-  line(7*ke + 12);
-
-  for(i=0; i < 6+20*index; i++){
-    if(df[i] == 0)
-      printf("Inf  ");
-    else
-      printf("%3i  ", df[i]);
-
-    for(j=0; j <= ke; j++){
-      q = smrng_lq(1.0-alpha, k[j], df[i], nrng, xeps, peps, &itr);
-      if(q < 100.0)
-        printf("%7.3lf", q);
-      else
-        printf("%7.2lf", q);
-      if(itr > itrmax)
-        itrmax = itr;
+    t.df[i + 20*index] = 120*index/(5 - i);
+  t.df[5 + 20*index] = 0;
+
+  if(argc >= 5) {
+    for(nn=0, c=argv[4]; ; c++) {
+      if(nn == NNRNG) {
+        printf("more than %i values of nrng\n", NNRNG);
+        exit(1);
+      }
+      s = c;
+      nrng[nn] = (int)strtol(s, &c, 10);
+      if(c == s || (*c != ',' && *c != '\0') || nrng[nn] <= 0) {
+        printf("invalid nrng: %s\n", argv[4]);
+        exit(1);
+      }
+      nn++;
+      if(*c == '\0')
+        break;
+    }
+  }
+
+  if(argc >= 6)
+    nthr = atoi(argv[5]);
+  if(nthr <= 0)
+    nthr = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if(nthr < 1)
+    nthr = 1;
+  if(nthr > NTHR)
+    nthr = NTHR;
+
+  t.nk = ke + 1;
+  t.ndf = 6 + 20*index;
+  pthread_mutex_init(&t.mtx, NULL);
+  pthread_cond_init(&t.cnd, NULL);
+
+  for(l=0; l < nn; l++) {
+    t.nrng = nrng[l];
+    t.left = t.nk*t.ndf;
+    for(i=0; i < t.ndf; i++)
+      for(j=0; j < t.nk; j++)
+        t.st[i][j] = 0;
+    for(j=0; j < t.nk; j++)
+      if((t.pl[j] = smrng_plan_new(t.k[j], t.df[0], t.nrng, 16, 6))
+         == NULL) {
+        printf("no memory\n");
+        exit(1);
+      }
+    if(nthr == 1)
+      worker(&t);
+    else {
+      for(i=0; i < nthr; i++)
+        if(pthread_create(&thr[i], NULL, worker, &t) != 0)
+          break;
+      if(i == 0)
+        worker(&t);
+      for(j=0; j < i; j++)
+        pthread_join(thr[j], NULL);
     }
+    for(j=0; j < t.nk; j++)
+      smrng_plan_free(t.pl[j]);
+
+    printf("The Studentised maximum range upper quantiles\n"
+           "q(k, df, no.ranges=%4i; alpha=%5.2lf)\n", t.nrng, t.alpha);
+    line(7*ke + 12);
+    printf(" df  k->%3i", t.k[0]);
+    for(j=1; j <= ke; j++)
+      printf("%7i", t.k[j]);
     printf("\n");
+    line(7*ke + 12);
+
+    itrmax = 0;
+    for(i=0; i < t.ndf; i++){
+      if(t.df[i] == 0)
+        printf("Inf  ");
+      else
+        printf("%3i  ", t.df[i]);
 
-    if((i+1)%10==0)
-      line(7*ke+12);
-    if((i+1)==20 && index==2){
-      printf(" df  k->%3i", k[0]);
-      for(j=1; j <= ke; j++)
-        printf("%7i", k[j]);
+      for(j=0; j <= ke; j++){
+        q = t.q[i][j];
+        if(q < 100.0)
+          printf("%7.3lf", q);
+        else
+          printf("%7.2lf", q);
+        if(t.itr[i][j] > itrmax)
+          itrmax = t.itr[i][j];
+      }
       printf("\n");
-      line(7*ke+12);
+
+      if((i+1)%10==0)
+        line(7*ke+12);
+      if((i+1)==20 && index==2){
+        printf(" df  k->%3i", t.k[0]);
+        for(j=1; j <= ke; j++)
+          printf("%7i", t.k[j]);
+        printf("\n");
+        line(7*ke+12);
+      }
     }
-  }
-  line(7*ke+12);
+    line(7*ke+12);
 
-  printf("max.iterations = %5i\n", itrmax);
+    printf("max.iterations = %5i\n", itrmax);
+  }
+  pthread_mutex_destroy(&t.mtx);
+  pthread_cond_destroy(&t.cnd);
 }